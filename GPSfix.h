@@ -205,6 +205,27 @@ public:
   #if defined(GPS_FIX_DATE) | defined(GPS_FIX_TIME)
     NeoGPS::time_t  dateTime   ; // Date and Time in one structure
     uint8_t         dateTime_cs; // hundredths of a second
+
+    // Date, time and hundredths in one value, for sorting and
+    // subtracting fix times.  Only meaningful if the date is valid.
+    NeoGPS::timestamp_t timestamp() const
+      { return NeoGPS::timestamp_t( dateTime, dateTime_cs * 10000UL ); }
+  #endif
+
+  //--------------------------------------------------------
+  //  Local receive times, from micros().  The transfer time includes
+  //  any gaps between merged sentences.
+
+  #ifdef GPS_FIX_RX_TIME
+    uint32_t rx_start_us    ; // '$' of the first sentence in this fix
+    uint32_t rx_completed_us; // DECODE_COMPLETED of the last sentence
+    uint32_t rx_parse_us    ; // time spent in decode for those sentences
+    uint32_t read_us        ; // when read() returned this fix
+
+    uint32_t transfer_us() const
+      { return rx_completed_us - rx_start_us - rx_parse_us; }
+    uint32_t queued_us  () const { return read_us - rx_completed_us; }
+    uint32_t latency_us () const { return read_us - rx_start_us; }
   #endif
 
   //--------------------------------------------------------
@@ -373,6 +394,13 @@ public:
       dateTime_cs = 0;
     #endif
 
+    #ifdef GPS_FIX_RX_TIME
+      rx_start_us     =
+      rx_completed_us =
+      rx_parse_us     =
+      read_us         = 0;
+    #endif
+
     status = STATUS_NONE;
 
     valid.init();
@@ -478,6 +506,12 @@ public:
         geoidHt = r.geoidHt;
     #endif
 
+    #ifdef GPS_FIX_RX_TIME
+      // Keep the start time of the first sentence
+      rx_completed_us  = r.rx_completed_us;
+      rx_parse_us     += r.rx_parse_us;
+    #endif
+
     // Update all the valid flags
     valid |= r.valid;
 
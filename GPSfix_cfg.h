@@ -32,4 +32,15 @@
 //#define GPS_FIX_ALT_ERR
 //#define GPS_FIX_GEOID_HEIGHT
 
+/**
+ * Enable/disable the local receive times of a fix.  These are micros()
+ * values taken when the first '$' (or UBX sync) arrives, when the last
+ * sentence is completed, and when the fix is read().  They are used to
+ * measure how stale a fix is (see gps_fix::latency_us).  Each fix is 16
+ * bytes larger, and each received character takes a few microseconds
+ * longer to process.
+ */
+
+//#define GPS_FIX_RX_TIME
+
 #endif
@@ -0,0 +1,412 @@
+/**
+ * @file GPSfusion.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "GPSfusion.h"
+
+#if defined(GPS_FIX_TIME) & defined(GPS_FIX_LOCATION)
+
+#include <math.h>
+
+static const uint32_t CS_PER_DAY = 24UL * 60 * 60 * 100;
+
+//  A fix this far behind the last fused epoch is not late: the
+//  receivers were stopped (e.g., overnight), so fusion starts over.
+
+static const uint32_t RESYNC_CS  = 60UL * 100;
+
+//------------------------------------------------------------------
+
+GPSfusion::GPSfusion( uint8_t receivers )
+  : late( 0 ), incomplete( 0 ), overruns( 0 ),
+    m_receivers( (receivers > FUSION_RECEIVERS) ? FUSION_RECEIVERS : receivers ),
+    m_last_key( 0 ), m_fused_any( false ), m_fused( 0 ),
+    m_out_head( 0 ), m_out_count( 0 )
+{
+  for (uint8_t i=0; i < FUSION_EPOCHS; i++)
+    m_slot[i].received = 0;
+}
+
+//------------------------------------------------------------------
+
+uint32_t GPSfusion::key_of( const gps_fix & fix )
+{
+  return ((fix.dateTime.hours   * 60UL +
+           fix.dateTime.minutes) * 60UL +
+           fix.dateTime.seconds) * 100UL +
+         fix.dateTime_cs;
+}
+
+//  Keys wrap at midnight, so /a/ is before /b/ if it is less than half
+//  a day earlier.
+
+bool GPSfusion::older( uint32_t a, uint32_t b )
+{
+  uint32_t diff = (b >= a) ? b - a : b + CS_PER_DAY - a;
+  return (diff != 0) && (diff < CS_PER_DAY/2);
+}
+
+//------------------------------------------------------------------
+
+GPSfusion::slot_t *GPSfusion::oldest()
+{
+  slot_t *oldest = (slot_t *) NULL;
+
+  for (uint8_t i=0; i < FUSION_EPOCHS; i++) {
+    slot_t & slot = m_slot[i];
+    if (slot.received && (!oldest || older( slot.key, oldest->key )))
+      oldest = &slot;
+  }
+
+  return oldest;
+}
+
+void GPSfusion::fuse_older( uint32_t key )
+{
+  for (;;) {
+    slot_t *slot = oldest();
+    if (!slot || !older( slot->key, key ))
+      break;
+    fuse( *slot );
+  }
+}
+
+//------------------------------------------------------------------
+
+bool GPSfusion::add( uint8_t receiver, const gps_fix & fix )
+{
+  if ((receiver >= m_receivers) || !fix.valid.time)
+    return false;
+
+  uint32_t key = key_of( fix );
+  if (m_fused_any && !older( m_last_key, key )) {
+    uint32_t behind = (m_last_key >= key) ? m_last_key - key
+                                          : m_last_key + CS_PER_DAY - key;
+    if (behind < RESYNC_CS) {
+      late++;
+      return false;
+    }
+    flush();
+    m_fused_any = false;
+  }
+
+  uint8_t fused = m_fused;
+
+  //  Find the slot for this epoch, or a free one.
+
+  slot_t *slot = (slot_t *) NULL;
+  slot_t *unused = (slot_t *) NULL;
+  for (uint8_t i=0; i < FUSION_EPOCHS; i++) {
+    if (!m_slot[i].received) {
+      if (!unused)
+        unused = &m_slot[i];
+    } else if (m_slot[i].key == key) {
+      slot = &m_slot[i];
+      break;
+    }
+  }
+
+  if (!slot) {
+    if (!unused) {
+      //  Fuse the oldest epoch without its missing receivers.
+      unused = oldest();
+      if (older( key, unused->key )) {
+        late++;
+        return false;
+      }
+      fuse( *unused );
+    }
+    slot           = unused;
+    slot->key      = key;
+    slot->received = 0;
+  }
+
+  slot->fix[ receiver ] = fix;
+  slot->received       |= (1 << receiver);
+
+  if (slot->received == (uint8_t) ((1 << m_receivers) - 1)) {
+    fuse_older( key );
+    fuse( *slot );
+  }
+
+  return (fused != m_fused);
+
+} // add
+
+//------------------------------------------------------------------
+
+void GPSfusion::flush()
+{
+  for (;;) {
+    slot_t *slot = oldest();
+    if (!slot)
+      break;
+    fuse( *slot );
+  }
+}
+
+//------------------------------------------------------------------
+
+const GPSfusion::fused_t & GPSfusion::read()
+{
+  const fused_t & fused = m_out[ m_out_head ];
+
+  if (m_out_count) {
+    m_out_count--;
+    m_out_head = (m_out_head == FUSION_EPOCHS-1) ? 0 : m_out_head+1;
+  }
+
+  return fused;
+}
+
+//------------------------------------------------------------------
+//  Sort a few indices by value.
+
+static void sort( uint8_t *index, const int32_t *value, uint8_t n )
+{
+  for (uint8_t i=1; i < n; i++) {
+    uint8_t j = i;
+    while ((j > 0) && (value[ index[j-1] ] > value[ index[j] ])) {
+      uint8_t t  = index[j];
+      index[j]   = index[j-1];
+      index[j-1] = t;
+      j--;
+    }
+  }
+}
+
+//  The receiver with the median value (the lower one, if /n/ is even).
+
+static uint8_t median_rx( const uint8_t *rx, const int32_t *value, uint8_t n )
+{
+  uint8_t index[ FUSION_RECEIVERS ];
+  for (uint8_t i=0; i < n; i++)
+    index[i] = i;
+  sort( index, value, n );
+
+  return rx[ index[ (n-1)/2 ] ];
+}
+
+static int32_t median( const int32_t *value, uint8_t n )
+{
+  uint8_t index[ FUSION_RECEIVERS ];
+  for (uint8_t i=0; i < n; i++)
+    index[i] = i;
+  sort( index, value, n );
+
+  int32_t lo = value[ index[ (n-1)/2 ] ];
+  int32_t hi = value[ index[ n/2 ] ];
+  return (lo >> 1) + (hi >> 1) + (lo & hi & 1); // without overflow
+}
+
+//  A better fix has a better status, and then a lower HDOP.
+
+static bool better( const gps_fix & a, const gps_fix & b )
+{
+  if (a.status != b.status)
+    return (a.status > b.status);
+
+  #ifdef GPS_FIX_HDOP
+    if (a.valid.hdop && b.valid.hdop)
+      return (a.hdop < b.hdop);
+    return a.valid.hdop;
+  #else
+    return false;
+  #endif
+}
+
+//------------------------------------------------------------------
+//  Vote on the location.  Returns the receivers that were used.
+
+uint8_t GPSfusion::vote
+  ( const slot_t & slot, int32_t & lat, int32_t & lon,
+    uint8_t & closest, quality_t & quality ) const
+{
+  int32_t lats[ FUSION_RECEIVERS ];
+  int32_t lons[ FUSION_RECEIVERS ];
+  uint8_t rx  [ FUSION_RECEIVERS ];
+  uint8_t n = 0;
+
+  for (uint8_t r=0; r < m_receivers; r++) {
+    if ((slot.received & (1 << r)) && slot.fix[r].valid.location) {
+      lats[n] = slot.fix[r].lat;
+      lons[n] = slot.fix[r].lon;
+      rx  [n] = r;
+      n++;
+    }
+  }
+
+  if (n == 0) {
+    quality = FUSION_NONE;
+    return 0;
+  }
+
+  lat = median( lats, n );
+  lon = median( lons, n );
+
+  //  1e-7 degrees of latitude is 1.11 cm.  Longitude is scaled by the
+  //  cosine of the latitude.
+
+  const float CM_PER_LAT = 1.1132;
+  float cm_per_lon = CM_PER_LAT * cos( lat * (1.0e-7 * M_PI / 180.0) );
+  float limit      = (float) FUSION_OUTLIER_CM * FUSION_OUTLIER_CM;
+
+  uint8_t used      = 0;
+  uint8_t count     = 0;
+  int32_t dlat_sum  = 0;
+  int32_t dlon_sum  = 0;
+
+  for (uint8_t i=0; i < n; i++) {
+    //  An outlier could be anywhere, so the distance is calculated
+    //  without integer overflow.
+    float y = ((float) lats[i] - (float) lat) * CM_PER_LAT;
+    float x = ((float) lons[i] - (float) lon) * cm_per_lon;
+    if (x*x + y*y <= limit) {
+      used     |= (1 << rx[i]);
+      dlat_sum += lats[i] - lat;
+      dlon_sum += lons[i] - lon;
+      count++;
+    }
+  }
+
+  if (count == 0) {
+    //  No agreement: use the best receiver.
+    closest = rx[0];
+    for (uint8_t i=1; i < n; i++)
+      if (better( slot.fix[ rx[i] ], slot.fix[ closest ] ))
+        closest = rx[i];
+    lat     = slot.fix[ closest ].lat;
+    lon     = slot.fix[ closest ].lon;
+    quality = FUSION_CONFLICT;
+    return (1 << closest);
+  }
+
+  lat += dlat_sum / count;
+  lon += dlon_sum / count;
+
+  //  The used receiver closest to the fused location
+
+  float closest_d = 0.0;
+  bool  found     = false;
+  for (uint8_t i=0; i < n; i++) {
+    if (used & (1 << rx[i])) {
+      float y = ((float) lats[i] - (float) lat) * CM_PER_LAT;
+      float x = ((float) lons[i] - (float) lon) * cm_per_lon;
+      float d = x*x + y*y;
+      if (!found || (d < closest_d)) {
+        closest_d = d;
+        closest   = rx[i];
+        found     = true;
+      }
+    }
+  }
+
+  if (n == 1)
+    quality = FUSION_SINGLE;
+  else if (used == (uint8_t) ((1 << m_receivers) - 1))
+    quality = FUSION_CONSENSUS;
+  else
+    quality = FUSION_MAJORITY;
+
+  return used;
+
+} // vote
+
+//------------------------------------------------------------------
+
+void GPSfusion::fuse( slot_t & slot )
+{
+  if (m_out_count == FUSION_EPOCHS) {
+    //  Keep the newest epochs.
+    overruns++;
+    read();
+  }
+
+  uint8_t i = m_out_head + m_out_count;
+  if (i >= FUSION_EPOCHS)
+    i -= FUSION_EPOCHS;
+  fused_t & out = m_out[i];
+  m_out_count++;
+
+  if (slot.received != (uint8_t) ((1 << m_receivers) - 1))
+    incomplete++;
+
+  int32_t lat, lon;
+  uint8_t closest;
+  out.received = slot.received;
+  out.used     = vote( slot, lat, lon, closest, out.quality );
+
+  if (out.used) {
+    out.fix     = slot.fix[ closest ];
+    out.fix.lat = lat;
+    out.fix.lon = lon;
+
+    //  Medians of the used receivers
+
+    #if defined(GPS_FIX_ALTITUDE) | defined(GPS_FIX_SPEED)
+      uint8_t rx   [ FUSION_RECEIVERS ];
+      int32_t value[ FUSION_RECEIVERS ];
+      uint8_t n;
+    #endif
+
+    #ifdef GPS_FIX_ALTITUDE
+      n = 0;
+      for (uint8_t r=0; r < m_receivers; r++) {
+        if ((out.used & (1 << r)) && slot.fix[r].valid.altitude) {
+          rx   [n] = r;
+          value[n] = slot.fix[r].altitude_cm();
+          n++;
+        }
+      }
+      if (n) {
+        out.fix.alt            = slot.fix[ median_rx( rx, value, n ) ].alt;
+        out.fix.valid.altitude = true;
+      }
+    #endif
+
+    #ifdef GPS_FIX_SPEED
+      n = 0;
+      for (uint8_t r=0; r < m_receivers; r++) {
+        if ((out.used & (1 << r)) && slot.fix[r].valid.speed) {
+          rx   [n] = r;
+          value[n] = slot.fix[r].speed_mkn();
+          n++;
+        }
+      }
+      if (n) {
+        out.fix.spd         = slot.fix[ median_rx( rx, value, n ) ].spd;
+        out.fix.valid.speed = true;
+      }
+    #endif
+
+  } else {
+    //  No location: use the first receiver.
+    uint8_t r = 0;
+    while (!(slot.received & (1 << r)))
+      r++;
+    out.fix = slot.fix[r];
+  }
+
+  m_last_key  = slot.key;
+  m_fused_any = true;
+  m_fused++;
+
+  slot.received = 0;
+
+} // fuse
+
+#endif
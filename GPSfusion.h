@@ -0,0 +1,145 @@
+#ifndef GPSFUSION_H
+#define GPSFUSION_H
+
+/**
+ * @file GPSfusion.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "GPSfix.h"
+
+#if defined(GPS_FIX_TIME) & defined(GPS_FIX_LOCATION)
+
+//------------------------------------------------------------------
+//  Fusion of the fixes from several receivers, each with its own
+//  NMEAGPS instance, into one fix per epoch.
+//
+//  The fixes from gps.read() are added with the receiver number.  They
+//  are aligned by their time of day (dateTime and dateTime_cs) in a
+//  small array of epoch slots: FUSION_EPOCHS slots of FUSION_RECEIVERS
+//  fixes each.  Nothing is allocated, so this can run in the same
+//  thread as the decoding.
+//
+//  An epoch is fused as soon as all receivers have reported it.  If a
+//  receiver is late, its epoch is fused without it when a newer epoch
+//  needs the slot (or when /flush/ is called).  A fix for an epoch that
+//  has already been fused is dropped and counted in /late/.  A fix more
+//  than a minute before the last fused epoch is not late: the receivers
+//  were stopped (e.g., overnight), so the pending epochs are fused and
+//  fusion starts over at the new time.
+//
+//  The location is the median of the receivers' locations.  Receivers
+//  more than FUSION_OUTLIER_CM from the median are rejected, and the
+//  rest are averaged.  If no receivers agree (e.g., two receivers that
+//  are too far apart), the one with the best status (and then HDOP) is
+//  used.  The other members are copied from the used receiver closest
+//  to the fused location, except for altitude and speed, which are
+//  medians of the used receivers.
+//
+//  Fixes are matched by time of day, so receivers must be configured
+//  for the same update rate.  Locations near the 180th meridian are
+//  not supported.
+
+#ifndef FUSION_RECEIVERS
+  #define FUSION_RECEIVERS 3
+#endif
+
+#ifndef FUSION_EPOCHS
+  #define FUSION_EPOCHS 2
+#endif
+
+#ifndef FUSION_OUTLIER_CM
+  #define FUSION_OUTLIER_CM 2000
+#endif
+
+#if (FUSION_RECEIVERS < 1) | (FUSION_RECEIVERS > 8)
+  #error FUSION_RECEIVERS must be 1..8!
+#endif
+
+class GPSfusion
+{
+public:
+
+  enum quality_t {
+    FUSION_NONE,      // no receiver had a valid location
+    FUSION_CONFLICT,  // no receivers agreed; the best one was used
+    FUSION_SINGLE,    // only one receiver had a valid location
+    FUSION_MAJORITY,  // agreement after rejecting or missing receivers
+    FUSION_CONSENSUS  // all receivers reported and agreed
+  };
+
+  struct fused_t {
+    gps_fix   fix;
+    quality_t quality;
+    uint8_t   received; // bit per receiver that reported this epoch
+    uint8_t   used;     // bit per receiver used in the location
+  };
+
+  explicit GPSfusion( uint8_t receivers = FUSION_RECEIVERS );
+
+  /**
+   * Add a fix from one receiver.  Fixes without a valid time are
+   * ignored.
+   * @param[in] receiver 0..receivers-1.
+   * @return true if an epoch was fused.
+   */
+  bool add( uint8_t receiver, const gps_fix & fix );
+
+  //  Fuse all pending epochs, complete or not.
+  void flush();
+
+  //  Fused epochs, oldest first.
+  uint8_t         available() const { return m_out_count; }
+  const fused_t & read();
+
+  //  Statistics
+  uint16_t late;        // fixes for an epoch that was already fused
+  uint16_t incomplete;  // epochs fused without all receivers
+  uint16_t overruns;    // fused epochs lost because they were not read
+
+protected:
+  uint8_t  m_receivers;
+
+  //  Epoch slots.  A slot is free when /received/ is 0.
+  struct slot_t {
+    uint32_t key;       // centiseconds of the day
+    uint8_t  received;
+    gps_fix  fix[ FUSION_RECEIVERS ];
+  };
+  slot_t   m_slot[ FUSION_EPOCHS ];
+
+  uint32_t m_last_key;  // of the last fused epoch
+  bool     m_fused_any;
+  uint8_t  m_fused;     // count of fused epochs, for /add/
+
+  //  Fused epochs, not yet read
+  fused_t  m_out[ FUSION_EPOCHS ];
+  uint8_t  m_out_head;
+  uint8_t  m_out_count;
+
+  static uint32_t key_of( const gps_fix & fix );
+  static bool     older ( uint32_t a, uint32_t b ); // a before b
+
+  slot_t *oldest();
+  void    fuse_older( uint32_t key );
+  void    fuse( slot_t & slot );
+  uint8_t vote( const slot_t & slot, int32_t & lat, int32_t & lon,
+                uint8_t & closest, quality_t & quality ) const;
+};
+
+#endif
+
+#endif
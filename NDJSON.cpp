@@ -0,0 +1,270 @@
+/**
+ * @file NDJSON.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "NDJSON.h"
+#include "GPSfix.h"
+
+//------------------------------------------------------------------
+//  The keys include their quotes and colon, so each member is one
+//  copy and one number conversion.  Every member is followed by a
+//  comma, and the last comma is replaced by the closing brace.
+//
+//  The numbers are written by the Streamers.cpp converters.  Scaled
+//  members (e.g., heading_cd() or hdop) go through put_fixed, which
+//  inserts the decimal point into the integer, and put_fixed writes
+//  the fraction with put_padded.  The status, satellite count and
+//  receive times use put_u16 and put_u32.
+
+#define JSON_KEY(name) static const char name##_key[] __PROGMEM = "\"" #name "\":"
+
+JSON_KEY(status);
+
+#if defined(GPS_FIX_DATE) | defined(GPS_FIX_TIME)
+  JSON_KEY(utc);
+  JSON_KEY(date);
+  JSON_KEY(time);
+#endif
+#ifdef GPS_FIX_LOCATION
+  JSON_KEY(lat);
+  JSON_KEY(lon);
+#endif
+#ifdef GPS_FIX_HEADING
+  JSON_KEY(heading);
+#endif
+#ifdef GPS_FIX_SPEED
+  JSON_KEY(speed);
+#endif
+#ifdef GPS_FIX_ALTITUDE
+  JSON_KEY(alt);
+#endif
+#ifdef GPS_FIX_HDOP
+  JSON_KEY(hdop);
+#endif
+#ifdef GPS_FIX_VDOP
+  JSON_KEY(vdop);
+#endif
+#ifdef GPS_FIX_PDOP
+  JSON_KEY(pdop);
+#endif
+#ifdef GPS_FIX_LAT_ERR
+  JSON_KEY(lat_err);
+#endif
+#ifdef GPS_FIX_LON_ERR
+  JSON_KEY(lon_err);
+#endif
+#ifdef GPS_FIX_ALT_ERR
+  JSON_KEY(alt_err);
+#endif
+#ifdef GPS_FIX_GEOID_HEIGHT
+  JSON_KEY(geoid_ht);
+#endif
+#ifdef GPS_FIX_SATELLITES
+  JSON_KEY(sats);
+#endif
+#ifdef GPS_FIX_RX_TIME
+  JSON_KEY(xfer_us);
+  JSON_KEY(parse_us);
+  JSON_KEY(queue_us);
+#endif
+
+#undef JSON_KEY
+
+// Copy a key without its NUL.  JSON_KEY declares arrays, so sizeof
+// gives the length of the key.
+#define PUT_KEY(p,name) \
+  (memcpy_P( p, name##_key, sizeof(name##_key)-1 ), p += sizeof(name##_key)-1)
+
+//------------------------------------------------------------------
+
+uint16_t format_json( char *buf, uint16_t size, const gps_fix &fix )
+{
+  if (size < JSON_FORMAT_MAX)
+    return 0;
+
+  char *p = buf;
+  *p++ = '{';
+
+  if (fix.valid.status) {
+    PUT_KEY( p, status );
+    p    = put_u16( p, (uint8_t) fix.status );
+    *p++ = ',';
+  }
+
+  #if defined(GPS_FIX_DATE) | defined(GPS_FIX_TIME)
+    bool date_ok = false;
+    bool time_ok = false;
+    #if defined(GPS_FIX_DATE)
+      date_ok = fix.valid.date;
+    #endif
+    #if defined(GPS_FIX_TIME)
+      time_ok = fix.valid.time;
+    #endif
+
+    if (date_ok || time_ok) {
+      //  Format "YYYY-MM-DD HH:MM:SS" after the key, then keep the
+      //  part that is valid.
+      char *dt;
+      if (date_ok && time_ok)
+        PUT_KEY( p, utc );
+      else if (date_ok)
+        PUT_KEY( p, date );
+      else
+        PUT_KEY( p, time );
+      *p++ = '\"';
+      dt   = p;
+      p   += fix.dateTime.format( p );
+
+      if (date_ok && time_ok) {
+        dt[10] = 'T';
+        *p++   = '.';
+        p      = put_2digits( p, fix.dateTime_cs );
+        *p++   = 'Z';
+      } else if (date_ok) {
+        p = dt + 10;
+      } else {
+        memmove( dt, dt+11, 8 );
+        p    = dt + 8;
+        *p++ = '.';
+        p    = put_2digits( p, fix.dateTime_cs );
+      }
+      *p++ = '\"';
+      *p++ = ',';
+    }
+  #endif
+
+  #ifdef GPS_FIX_LOCATION
+    if (fix.valid.location) {
+      PUT_KEY( p, lat );
+      p    = put_fixed( p, fix.latitudeL(), 7 );
+      *p++ = ',';
+      PUT_KEY( p, lon );
+      p    = put_fixed( p, fix.longitudeL(), 7 );
+      *p++ = ',';
+    }
+  #endif
+  #ifdef GPS_FIX_HEADING
+    if (fix.valid.heading) {
+      PUT_KEY( p, heading );
+      p    = put_fixed( p, fix.heading_cd(), 2 );
+      *p++ = ',';
+    }
+  #endif
+  #ifdef GPS_FIX_SPEED
+    if (fix.valid.speed) {
+      PUT_KEY( p, speed );
+      p    = put_fixed( p, fix.speed_mkn(), 3 );
+      *p++ = ',';
+    }
+  #endif
+  #ifdef GPS_FIX_ALTITUDE
+    if (fix.valid.altitude) {
+      PUT_KEY( p, alt );
+      p    = put_fixed( p, fix.altitude_cm(), 2 );
+      *p++ = ',';
+    }
+  #endif
+
+  #ifdef GPS_FIX_HDOP
+    if (fix.valid.hdop) {
+      PUT_KEY( p, hdop );
+      p    = put_fixed( p, fix.hdop, 3 );
+      *p++ = ',';
+    }
+  #endif
+  #ifdef GPS_FIX_VDOP
+    if (fix.valid.vdop) {
+      PUT_KEY( p, vdop );
+      p    = put_fixed( p, fix.vdop, 3 );
+      *p++ = ',';
+    }
+  #endif
+  #ifdef GPS_FIX_PDOP
+    if (fix.valid.pdop) {
+      PUT_KEY( p, pdop );
+      p    = put_fixed( p, fix.pdop, 3 );
+      *p++ = ',';
+    }
+  #endif
+
+  #ifdef GPS_FIX_LAT_ERR
+    if (fix.valid.lat_err) {
+      PUT_KEY( p, lat_err );
+      p    = put_fixed( p, fix.lat_err_cm, 2 );
+      *p++ = ',';
+    }
+  #endif
+  #ifdef GPS_FIX_LON_ERR
+    if (fix.valid.lon_err) {
+      PUT_KEY( p, lon_err );
+      p    = put_fixed( p, fix.lon_err_cm, 2 );
+      *p++ = ',';
+    }
+  #endif
+  #ifdef GPS_FIX_ALT_ERR
+    if (fix.valid.alt_err) {
+      PUT_KEY( p, alt_err );
+      p    = put_fixed( p, fix.alt_err_cm, 2 );
+      *p++ = ',';
+    }
+  #endif
+
+  #ifdef GPS_FIX_GEOID_HEIGHT
+    if (fix.valid.geoidHeight) {
+      PUT_KEY( p, geoid_ht );
+      p    = put_fixed( p, fix.geoidHeight_cm(), 2 );
+      *p++ = ',';
+    }
+  #endif
+
+  #ifdef GPS_FIX_SATELLITES
+    if (fix.valid.satellites) {
+      PUT_KEY( p, sats );
+      p    = put_u16( p, fix.satellites );
+      *p++ = ',';
+    }
+  #endif
+
+  #ifdef GPS_FIX_RX_TIME
+    PUT_KEY( p, xfer_us );
+    p    = put_u32( p, fix.transfer_us() );
+    *p++ = ',';
+    PUT_KEY( p, parse_us );
+    p    = put_u32( p, fix.rx_parse_us );
+    *p++ = ',';
+    PUT_KEY( p, queue_us );
+    p    = put_u32( p, fix.queued_us() );
+    *p++ = ',';
+  #endif
+
+  // Replace the last comma, or close an empty object.
+  if (p[-1] == ',')
+    p--;
+  *p++ = '}';
+  *p++ = '\n';
+
+  return p - buf;
+
+} // format_json
+
+//------------------------------------------------------------------
+
+void trace_json( Print & outs, const gps_fix &fix )
+{
+  char buf[ JSON_FORMAT_MAX ];
+  outs.write( (const uint8_t *) buf, format_json( buf, sizeof(buf), fix ) );
+}
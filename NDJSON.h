@@ -0,0 +1,108 @@
+#ifndef NDJSON_H
+#define NDJSON_H
+
+/**
+ * @file NDJSON.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "Streamers.h"
+
+//------------------------------------------------------------------
+//  Newline-delimited JSON ("JSON Lines") output of a gps_fix.
+//
+//  Each fix becomes one object on one line, for example:
+//
+//    {"status":3,"utc":"2002-12-09T08:35:59.00Z","lat":47.2852395,
+//     "lon":8.5652537,"heading":77.52,"speed":0.004,"sats":8}
+//
+//  Only members that are enabled in GPSfix_cfg.h *and* marked valid
+//  are included.  The keys are PROGMEM strings selected at compile
+//  time, and all values are formatted from the integer members, so no
+//  floating-point code is linked in.  Units are degrees, meters, knots,
+//  and unitless DOP.  The "utc" member is used when both the date and
+//  time are valid; otherwise only "date" or "time" is included.
+
+/**
+ * The largest number of characters that format_json can write for
+ * the compile-time configuration, including the newline.  Each entry
+ * is the key, the largest value and a comma.
+ */
+const uint16_t JSON_FORMAT_MAX =
+  3                        // braces and newline
+  + 13                     // "status":255,
+  #if defined(GPS_FIX_DATE) | defined(GPS_FIX_TIME)
+    + 32                   // "utc":"YYYY-MM-DDTHH:MM:SS.ccZ",
+  #endif
+  #ifdef GPS_FIX_LOCATION
+    + 2*19                 // "lat":-214.7483648,
+  #endif
+  #ifdef GPS_FIX_HEADING
+    + 17                   // "heading":655.35,
+  #endif
+  #ifdef GPS_FIX_SPEED
+    + 21                   // "speed":-2147483.648,
+  #endif
+  #ifdef GPS_FIX_ALTITUDE
+    + 19                   // "alt":-21474836.48,
+  #endif
+  #ifdef GPS_FIX_HDOP
+    + 14                   // "hdop":65.535,
+  #endif
+  #ifdef GPS_FIX_VDOP
+    + 14
+  #endif
+  #ifdef GPS_FIX_PDOP
+    + 14
+  #endif
+  #ifdef GPS_FIX_LAT_ERR
+    + 17                   // "lat_err":655.35,
+  #endif
+  #ifdef GPS_FIX_LON_ERR
+    + 17
+  #endif
+  #ifdef GPS_FIX_ALT_ERR
+    + 17
+  #endif
+  #ifdef GPS_FIX_GEOID_HEIGHT
+    + 24                   // "geoid_ht":-21474836.48,
+  #endif
+  #ifdef GPS_FIX_SATELLITES
+    + 11                   // "sats":255,
+  #endif
+  #ifdef GPS_FIX_RX_TIME
+    + 3*22                 // "parse_us":4294967295,
+  #endif
+  ;
+
+/**
+ * Format one JSON object and a newline into a character buffer.
+ * The buffer is not NUL-terminated.
+ * @param[out] buf character buffer.
+ * @param[in] size of /buf/, which must be at least JSON_FORMAT_MAX.
+ * @param[in] fix gps_fix instance.
+ * @return number of characters written, or 0 if /buf/ is too small.
+ */
+extern uint16_t format_json( char *buf, uint16_t size, const gps_fix &fix );
+
+/**
+ * Write one JSON line for the fix, with a single write call.
+ * @param[in] outs output stream.
+ * @param[in] fix gps_fix instance.
+ */
+extern void trace_json( Print & outs, const gps_fix &fix );
+
+#endif
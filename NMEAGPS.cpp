@@ -80,6 +80,22 @@ NMEAGPS::NMEAGPS()
 
   data_init();
 
+  #ifdef NMEAGPS_AUTO_INTERVAL
+    _lastSentence = LAST_SENTENCE_IN_INTERVAL; // initial guess
+    _lastRun      = 1;
+    _nextSentence = NMEA_UNKNOWN;
+    _nextRun      = 0;
+    _prevSentence = NMEA_UNKNOWN;
+    _run          = 0;
+
+    _intervalTime.hours   =
+    _intervalTime.minutes =
+    _intervalTime.seconds =
+    _intervalTime.cs      = 0;
+  #endif
+
+  intervalComplete( true ); // nothing accumulated yet
+
   reset();
 }
 
@@ -94,6 +110,10 @@ void NMEAGPS::sentenceBegin()
   chrCount     = 0;
   comma_needed( false );
 
+  #ifdef GPS_FIX_RX_TIME
+    rxTimeBegin();
+  #endif
+
   #ifdef NMEAGPS_PARSE_PROPRIETARY
     proprietary  = false;
 
@@ -124,6 +144,12 @@ void NMEAGPS::sentenceOk()
     parseField(',');
   }
 
+  #if defined(NMEAGPS_PARSE_GSV) & defined(NMEAGPS_PARSE_SATELLITES)
+    // The last GSV of a constellation is only complete when its CS is ok.
+    if ((nmeaMessage == NMEA_GSV) && m_gsv_ok && (m_gsv_msg == m_gsv_total))
+      m_gsv_complete |= (1 << m_gsv_con);
+  #endif
+
   #ifdef NMEAGPS_STATS
     statistics.ok++;
   #endif
@@ -380,6 +406,10 @@ NMEAGPS::decode_t NMEAGPS::parseCommand( char c )
           return DECODE_CHR_INVALID;
       #endif
 
+      #if defined(NMEAGPS_PARSE_GSV) & defined(NMEAGPS_PARSE_SATELLITES)
+        gsvTalker( c );
+      #endif
+
       return DECODE_CHR_OK;
     }
     
@@ -680,50 +710,48 @@ bool NMEAGPS::parseGSV( char chr )
         case 3: return parseSatellites( chr );
 
         #ifdef NMEAGPS_PARSE_SATELLITES
-          case 1:
-            // allows "default:" case for SV fields
+          case 1: // number of GSV messages
+            parseInt( m_gsv_total, chr );
             break;
           case 2: // GSV message number (e.g., 2nd of n)
             if (chr != ',')
-              // sat_count is temporarily used to hold the MsgNo...
-              parseInt( sat_count, chr );
+              parseInt( m_gsv_msg, chr );
             else
-              // ...then it's converted to the real sat_count
-              // based on up to 4 satellites per msg.
-              sat_count = (sat_count - 1) * 4;
+              gsvBegin();
             break;
 
           default:
-            if (sat_count < NMEAGPS_MAX_SATELLITES) {
+            if (!m_gsv_ok)
+              break;
+
+            if (fieldIndex % 4 == 0) { // a satellite ID starts a new entry
+              if (chrCount == 0)
+                m_gsv_sat = (chr == ',') ? NO_SAT : gsvAdd();
+              if (m_gsv_sat != NO_SAT)
+                parseInt( satellites[m_gsv_sat].id, chr );
+              break;
+            }
+
+            #ifdef NMEAGPS_PARSE_SATELLITE_INFO
+              if (m_gsv_sat == NO_SAT)
+                break;
+
+              satellite_view_t & sat = satellites[m_gsv_sat];
 
               switch (fieldIndex % 4) {
-                #ifdef NMEAGPS_PARSE_SATELLITE_INFO
-                  case 0: parseInt( satellites[sat_count].id       , chr ); break;
-                  case 1: parseInt( satellites[sat_count].elevation, chr ); break;
-                  case 2:
-                    if (chr != ',')
-                      parseInt( satellites[sat_count].azimuth, chr );
-                    else
-                      sat_count++; // field 3 can be omitted, increment now
-                    break;
-                  case 3:
-                    if (chr != ',') {
-                      uint8_t snr = satellites[sat_count-1].snr;
-                      parseInt( snr, chr );
-                      satellites[sat_count-1].snr = snr;
-                    } else
-                      satellites[sat_count-1].tracked = (chrCount != 0);
-                    break;
-                #else
-                  case 0:
-                    if (chr != ',')
-                      parseInt( satellites[sat_count].id, chr );
-                    else
-                      sat_count++;
-                    break;
-                #endif
+                case 1: parseInt( sat.elevation, chr ); break;
+                case 2: parseInt( sat.azimuth  , chr ); break;
+                case 3:
+                  if (chr != ',') {
+                    uint8_t snr = sat.snr;
+                    parseInt( snr, chr );
+                    sat.snr     = snr;
+                    sat.tracked = true; // the last field may not get a comma
+                  } else
+                    sat.tracked = (chrCount != 0);
+                  break;
               }
-            }
+            #endif
         #endif
     }
   #endif
@@ -732,6 +760,126 @@ bool NMEAGPS::parseGSV( char chr )
 
 } // parseGSV
 
+#if defined(NMEAGPS_PARSE_GSV) & defined(NMEAGPS_PARSE_SATELLITES)
+
+//---------------------------------
+//  The satellites[] array holds a block for each constellation, in
+//  constellation_t order, so that it is always contiguous.  The block
+//  of a constellation is replaced when its first GSV message arrives,
+//  and a satellite is only added if each message arrived in order.
+
+uint8_t NMEAGPS::max_satellites( uint8_t c )
+{
+  switch (c) {
+    case GNSS_GLONASS: return NMEAGPS_MAX_GLONASS_SATELLITES;
+    case GNSS_GALILEO: return NMEAGPS_MAX_GALILEO_SATELLITES;
+    case GNSS_BEIDOU : return NMEAGPS_MAX_BEIDOU_SATELLITES;
+    default          : return NMEAGPS_MAX_GPS_SATELLITES;
+  }
+}
+
+void NMEAGPS::gsvTalker( char c )
+{
+  if (chrCount == 0) {
+    m_gsv_talker0 = c;
+    return;
+  }
+
+  uint8_t con = GNSS_GPS;
+  if (m_gsv_talker0 == 'G') {
+    if (c == 'L')
+      con = GNSS_GLONASS;
+    else if (c == 'A')
+      con = GNSS_GALILEO;
+    else if (c == 'B')
+      con = GNSS_BEIDOU;
+  } else if ((m_gsv_talker0 == 'B') && (c == 'D'))
+    con = GNSS_BEIDOU;
+
+  m_gsv_con = con;
+
+} // gsvTalker
+
+void NMEAGPS::gsvBegin()
+{
+  m_gsv_sat = NO_SAT;
+
+  //  Ignore a constellation without any slots.  It does not take part in
+  //  the interval, so it cannot replace or complete another one.
+  if (max_satellites( m_gsv_con ) == 0) {
+    m_gsv_ok = false;
+    return;
+  }
+
+  gsv_t & gsv = m_gsv[ m_gsv_con ];
+  uint8_t bit = (1 << m_gsv_con);
+
+  if (m_gsv_msg == 1) {
+    if (m_gsv_round & bit) {
+      //  This constellation already started in the current epoch, so a
+      //  new epoch has begun.  Constellations that did not report in
+      //  the previous epoch are no longer in view.
+      for (uint8_t c=0; c < GNSS_COUNT; c++)
+        if (!(m_gsv_round & (1 << c)))
+          gsvRemove( c );
+      m_gsv_expected = m_gsv_round;
+      m_gsv_round    = 0;
+      m_gsv_complete = 0;
+    }
+    m_gsv_round    |= bit;
+    m_gsv_complete &= ~bit;
+    gsvRemove( m_gsv_con );
+    gsv.next_msg = 1;
+  }
+
+  m_gsv_ok = (gsv.next_msg != 0) && (m_gsv_msg == gsv.next_msg);
+  if (m_gsv_ok)
+    gsv.next_msg++;
+  else
+    gsv.next_msg = 0; // a message was lost, ignore the rest
+
+} // gsvBegin
+
+//  Insert a satellite at the end of the current constellation's block.
+
+uint8_t NMEAGPS::gsvAdd()
+{
+  gsv_t & gsv = m_gsv[ m_gsv_con ];
+
+  if ((gsv.count >= max_satellites( m_gsv_con )) ||
+      (sat_count >= NMEAGPS_MAX_SATELLITES))
+    return NO_SAT;
+
+  uint8_t i = constellation_start( (constellation_t) m_gsv_con ) + gsv.count;
+  if (i > sat_count)
+    return NO_SAT; // the array was changed by something else (e.g., UBX)
+
+  memmove( &satellites[i+1], &satellites[i],
+           (sat_count - i) * sizeof(satellites[0]) );
+  memset( &satellites[i], 0, sizeof(satellites[0]) );
+  gsv.count++;
+  sat_count++;
+
+  return i;
+
+} // gsvAdd
+
+void NMEAGPS::gsvRemove( uint8_t c )
+{
+  uint8_t count = m_gsv[c].count;
+  if (count) {
+    uint8_t i = constellation_start( (constellation_t) c );
+    if (i + count <= sat_count) {
+      memmove( &satellites[i], &satellites[i+count],
+               (sat_count - i - count) * sizeof(satellites[0]) );
+      sat_count -= count;
+    }
+    m_gsv[c].count = 0;
+  }
+}
+
+#endif
+
 //---------------------------------
 
 bool NMEAGPS::parseRMC( char chr )
@@ -1404,6 +1552,65 @@ bool NMEAGPS::parse_alt_err( char chr )
 
 //---------------------------------
 
+#ifdef NMEAGPS_AUTO_INTERVAL
+
+  bool NMEAGPS::newInterval()
+  {
+    // With EXPLICIT or NO merging, fix() only contains the members
+    //   of the sentence that was just completed.
+    bool changed =
+      m_fix.valid.time &&
+      ((m_fix.dateTime_cs      != _intervalTime.cs     ) ||
+       (m_fix.dateTime.seconds != _intervalTime.seconds) ||
+       (m_fix.dateTime.minutes != _intervalTime.minutes) ||
+       (m_fix.dateTime.hours   != _intervalTime.hours  ));
+
+    if (changed) {
+      // The previous sentence was the last one in its interval.  Use
+      //   it after the same order has been seen twice, so that one
+      //   odd interval (e.g., a dropped sentence) is not learned.
+      if (_prevSentence != NMEA_UNKNOWN) {
+        if ((_prevSentence == _nextSentence) && (_run == _nextRun)) {
+          _lastSentence = _prevSentence;
+          _lastRun      = _run;
+        }
+        _nextSentence = _prevSentence;
+        _nextRun      = _run;
+      }
+      _prevSentence = NMEA_UNKNOWN;
+
+      _intervalTime.hours   = m_fix.dateTime.hours;
+      _intervalTime.minutes = m_fix.dateTime.minutes;
+      _intervalTime.seconds = m_fix.dateTime.seconds;
+      _intervalTime.cs      = m_fix.dateTime_cs;
+    }
+
+    // Count repeated sentences (e.g., GSA) so that the interval
+    //   is not completed by the first one.  The number of GSV
+    //   messages changes with the satellites in view, so only the
+    //   last GSV of each constellation is counted.
+    bool counted = true;
+    #if defined(NMEAGPS_PARSE_GSV) & defined(NMEAGPS_PARSE_SATELLITES)
+      if (nmeaMessage == NMEA_GSV)
+        counted = (m_gsv_msg == m_gsv_total);
+    #endif
+
+    if (nmeaMessage == _prevSentence) {
+      if (counted && (_run < 255))
+        _run++;
+    } else {
+      _prevSentence = nmeaMessage;
+      _run          = counted;
+    }
+
+    return changed;
+
+  } // newInterval
+
+#endif
+
+//---------------------------------
+
 const gps_fix & NMEAGPS::read()
 {
   if (_fixesAvailable) {
@@ -1415,9 +1622,15 @@ const gps_fix & NMEAGPS::read()
         if (_firstFix >= NMEAGPS_FIX_MAX)
           _firstFix = 0;
       unlock();
+      #ifdef GPS_FIX_RX_TIME
+        buffer[i].read_us = micros();
+      #endif
       return buffer[i];
     #else
       _fixesAvailable = false;
+      #ifdef GPS_FIX_RX_TIME
+        m_fix.read_us = micros();
+      #endif
       return m_fix;
     #endif
 
@@ -1500,18 +1713,44 @@ void NMEAGPS::poll( Stream *device, nmea_msg_t msg )
 
 //---------------------------------
 
-static void send_trailer( Stream *device, uint8_t crc )
+//  Outgoing characters are collected in a small stack buffer and
+//  written to the device with one call, instead of one virtual
+//  print call per character.  Messages longer than the NMEA limit
+//  are written in several chunks.
+
+class send_buffer_t
 {
-  device->print('*');
+public:
+  send_buffer_t( Stream *device ) : m_device( device ), m_len( 0 ) {}
 
-  char hexDigit = formatHex( crc>>4 );
-  device->print( hexDigit );
+  void put( char c )
+  {
+    if (m_len == sizeof(m_buf))
+      flush();
+    m_buf[ m_len++ ] = c;
+  }
+
+  void flush()
+  {
+    m_device->write( (const uint8_t *) m_buf, m_len );
+    m_len = 0;
+  }
 
-  hexDigit = formatHex( crc );
-  device->print( hexDigit );
+private:
+  Stream *m_device;
+  char    m_buf[ 82 ]; // longest NMEA sentence, including CR/LF
+  uint8_t m_len;
+};
 
-  device->print( CR );
-  device->print( LF );
+//---------------------------------
+
+static void send_trailer( send_buffer_t & out, uint8_t crc )
+{
+  out.put( '*' );
+  out.put( formatHex( crc>>4 ) );
+  out.put( formatHex( crc ) );
+  out.put( CR );
+  out.put( LF );
 }
 
 //---------------------------------
@@ -1519,7 +1758,9 @@ static void send_trailer( Stream *device, uint8_t crc )
 void NMEAGPS::send( Stream *device, const char *msg )
 {
   if (msg && *msg) {
-    device->print('$');
+    send_buffer_t out( device );
+
+    out.put( '$' );
     if (*msg == '$')
       msg++;
     uint8_t sent_trailer = 0;
@@ -1528,11 +1769,12 @@ void NMEAGPS::send( Stream *device, const char *msg )
       crc ^= *msg;
       if (*msg == '*' || (sent_trailer > 0))
         sent_trailer++;
-      device->print( *msg++ );
+      out.put( *msg++ );
     }
 
     if (sent_trailer != 3)
-      send_trailer( device, crc );
+      send_trailer( out, crc );
+    out.flush();
   }
 
 } // send
@@ -1542,22 +1784,25 @@ void NMEAGPS::send( Stream *device, const char *msg )
 void NMEAGPS::send_P( Stream *device, const __FlashStringHelper *msg )
 {
   if (msg) {
+    send_buffer_t out( device );
+
     const char *ptr = (const char *)msg;
     char chr = pgm_read_byte(ptr++);
     if (chr && (chr != '$'))
-      device->print('$');
+      out.put( '$' );
     uint8_t sent_trailer = 0;
     uint8_t crc = 0;
     while (chr) {
       crc ^= chr;
       if ((chr == '*') || (sent_trailer > 0))
         sent_trailer++;
-      device->print( chr );
+      out.put( chr );
       chr = pgm_read_byte(ptr++);
     }
 
     if (sent_trailer != 3)
-      send_trailer( device, crc );
+      send_trailer( out, crc );
+    out.flush();
   }
 
 } // send_P
@@ -28,6 +28,10 @@ class Stream;
 #include "GPSfix.h"
 #include "NMEAGPS_cfg.h"
 
+#ifdef GPS_FIX_RX_TIME
+  #include <Arduino.h> // for micros()
+#endif
+
 //------------------------------------------------------
 //
 // NMEA 0183 Parser for generic GPS Modules.  As bytes are received from
@@ -270,6 +274,12 @@ public:
     bool intervalComplete() const { return _intervalComplete; }
     void intervalComplete( bool val ) { _intervalComplete = val; }
 
+    #ifdef NMEAGPS_AUTO_INTERVAL
+      //  The sentence that has been learned to be the last one
+      //    in each interval (see NMEAGPS_cfg.h).
+      nmea_msg_t lastSentenceInInterval() const { return _lastSentence; }
+    #endif
+
     //.......................................................................
     // Set all parsed data (fix(), satellite info, etc.) to initial values.
 
@@ -277,8 +287,24 @@ public:
     {
       fix().init();
 
+      #ifdef GPS_FIX_RX_TIME
+        m_rx_start_us = 0;
+        m_rx_parse_us = 0;
+        m_rx_started  = false;
+      #endif
+
       #ifdef NMEAGPS_PARSE_SATELLITES
         sat_count = 0;
+
+        #ifdef NMEAGPS_PARSE_GSV
+          for (uint8_t i=0; i < GNSS_COUNT; i++) {
+            m_gsv[i].count    = 0;
+            m_gsv[i].next_msg = 0;
+          }
+          m_gsv_round    =
+          m_gsv_expected =
+          m_gsv_complete = 0;
+        #endif
       #endif
     }
 
@@ -300,6 +326,34 @@ protected:
     //  Current fix
     gps_fix m_fix;
 
+    #ifdef GPS_FIX_RX_TIME
+      //  Receive times of the current sentence.  They are applied to
+      //    m_fix when the sentence is completed, so characters after
+      //    the end of a fix do not change its times.
+      uint32_t m_rx_start_us; // '$' (or UBX sync) of this sentence
+      uint32_t m_rx_parse_us; // time spent in decode for this sentence
+      bool     m_rx_started;  // m_fix has the start of its first sentence
+
+      void rxTimeBegin()
+      {
+        m_rx_start_us = micros();
+        m_rx_parse_us = 0;
+      }
+
+      void rxTimeCompleted( uint32_t now_us )
+      {
+        //  EXPLICIT_MERGING accumulates each sentence into the buffer,
+        //    so m_fix only has the times of this sentence.
+        if ((merging == EXPLICIT_MERGING) || !m_rx_started) {
+          m_fix.rx_start_us = m_rx_start_us;
+          m_fix.rx_parse_us = 0;
+          m_rx_started      = true;
+        }
+        m_fix.rx_parse_us    += m_rx_parse_us;
+        m_fix.rx_completed_us = now_us;
+      }
+    #endif
+
     // Current parser state
     uint8_t      crc;            // accumulated CRC in the sentence
     uint8_t      fieldIndex;     // index of current field in the sentence
@@ -355,12 +409,79 @@ protected:
 
     rxState_t rxState NEOGPS_BF(8);
 
+    //.......................................................................
+    //  Run-time detection of the interval boundary
+
+    #ifdef NMEAGPS_AUTO_INTERVAL
+      nmea_msg_t _lastSentence NEOGPS_BF(8); // learned last sentence in interval
+      nmea_msg_t _nextSentence NEOGPS_BF(8); // last sentence of the previous interval
+      nmea_msg_t _prevSentence NEOGPS_BF(8); // previous completed sentence
+      uint8_t    _lastRun;                   // times _lastSentence is repeated
+      uint8_t    _nextRun;                   // times _nextSentence was repeated
+      uint8_t    _run;                       // times _prevSentence was repeated
+
+      struct {
+        uint8_t hours;
+        uint8_t minutes;
+        uint8_t seconds;
+        uint8_t cs;
+      } _intervalTime; // time of the current interval
+
+      //  Learn the sentence order from the completed sentences.  The
+      //    order is only used after it has been seen in two intervals
+      //    in a row.
+      //  @return true if this sentence has a new time.
+      bool newInterval();
+
+      bool lastInInterval() const
+        { return (nmeaMessage == _lastSentence) && (_run >= _lastRun); }
+    #endif
+
     //.......................................................................
     //  Process one character, possibly saving a buffered fix
 
     void _handle( uint8_t c )
     {
-      if (decode( c ) == DECODE_COMPLETED) {
+      #ifdef GPS_FIX_RX_TIME
+        uint32_t decode_us = micros();
+      #endif
+
+      decode_t result = decode( c );
+
+      #ifdef GPS_FIX_RX_TIME
+        uint32_t now_us = micros();
+        m_rx_parse_us += now_us - decode_us;
+      #endif
+
+      if (result == DECODE_COMPLETED) {
+
+        #ifdef GPS_FIX_RX_TIME
+          rxTimeCompleted( now_us );
+        #endif
+
+        #ifdef NMEAGPS_AUTO_INTERVAL
+          if (newInterval()) {
+
+            #if (NMEAGPS_FIX_MAX > 0)
+              if ((merging == EXPLICIT_MERGING) && !intervalComplete()) {
+                // The last sentence of the previous interval was not
+                //   recognized.  Finish that fix now, before this
+                //   sentence is merged into the next one.
+                if (_available() >= NMEAGPS_FIX_MAX)
+                  overrun( true );
+                else {
+                  _currentFix++;
+                  if (_currentFix >= NMEAGPS_FIX_MAX)
+                    _currentFix = 0;
+
+                  _fixesAvailable++;
+                }
+              }
+            #endif
+
+            intervalComplete( true );
+          }
+        #endif
 
         // Room for another fix?
 
@@ -384,13 +505,30 @@ protected:
                   buffer[ _currentFix ] = fix(); // start fresh
                 else
               #endif
-                  buffer[ _currentFix ] |= fix();
+              {
+                #ifdef GPS_FIX_RX_TIME
+                  if (intervalComplete()) {
+                    // First sentence of this fix
+                    buffer[ _currentFix ].rx_start_us = fix().rx_start_us;
+                    buffer[ _currentFix ].rx_parse_us = 0;
+                  }
+                #endif
+                buffer[ _currentFix ] |= fix();
+              }
             }
           #endif
 
-          intervalComplete( nmeaMessage == LAST_SENTENCE_IN_INTERVAL );
+          #ifdef NMEAGPS_AUTO_INTERVAL
+            intervalComplete( lastInInterval() );
+          #else
+            intervalComplete( nmeaMessage == LAST_SENTENCE_IN_INTERVAL );
+          #endif
           if ((merging == NO_MERGING) || intervalComplete()) {
 
+            #ifdef GPS_FIX_RX_TIME
+              m_rx_started = false; // the next sentence starts a new fix
+            #endif
+
             #if (NMEAGPS_FIX_MAX > 0)
 
               if (merging != EXPLICIT_MERGING)
@@ -551,9 +689,64 @@ public:
       uint8_t sat_count;
 
       bool satellites_valid() const { return (sat_count >= m_fix.satellites); }
+
+      #ifdef NMEAGPS_PARSE_GSV
+        //  GSV satellites are grouped by constellation, in this order.
+        enum constellation_t {
+            GNSS_GPS,
+            GNSS_GLONASS,
+            GNSS_GALILEO,
+            GNSS_BEIDOU,
+            GNSS_COUNT
+          };
+
+        uint8_t constellation_count( constellation_t c ) const
+          { return m_gsv[c].count; }
+        uint8_t constellation_start( constellation_t c ) const
+          {
+            uint8_t start = 0;
+            for (uint8_t i=0; i < c; i++)
+              start += m_gsv[i].count;
+            return start;
+          }
+
+        //  True when the GSV sentences of every constellation in the
+        //  current epoch have been received, in order.  This is known
+        //  after the first complete epoch.
+        bool satellites_complete() const
+          { return m_gsv_expected &&
+                   ((m_gsv_expected & ~m_gsv_complete) == 0); }
+      #endif
     #endif
 
 protected:
+    #if defined(NMEAGPS_PARSE_GSV) & defined(NMEAGPS_PARSE_SATELLITES)
+      //  GSV assembly state for each constellation
+      struct gsv_t {
+        uint8_t count;     // satellites in its block
+        uint8_t next_msg;  // expected GSV message number, 0 = none
+      };
+      gsv_t   m_gsv[ GNSS_COUNT ];
+      uint8_t m_gsv_round;    // constellations that started in this epoch
+      uint8_t m_gsv_expected; // constellations in the previous epoch
+      uint8_t m_gsv_complete; // constellations with their last GSV
+
+      //  The current GSV sentence
+      char    m_gsv_talker0;  // first talker ID character
+      uint8_t m_gsv_con;      // its constellation_t
+      uint8_t m_gsv_total;    // number of GSV messages
+      uint8_t m_gsv_msg;      // this message number
+      uint8_t m_gsv_sat;      // index of the satellite being parsed
+      bool    m_gsv_ok;       // message is in order
+
+      static const uint8_t NO_SAT = 0xFF;
+
+      static uint8_t max_satellites( uint8_t c );
+      void    gsvTalker( char c );
+      void    gsvBegin();
+      uint8_t gsvAdd();
+      void    gsvRemove( uint8_t c );
+    #endif
 
     //.......................................................................
     // Parse floating-point numbers into a /whole_frac/
@@ -39,6 +39,32 @@
 // the last sentence the device sends if you have disabled
 // it.  Just select the last sentence that you have *enabled*.
 
+//------------------------------------------------------
+// Enable/Disable run-time detection of the interval boundary:
+//
+// Instead of depending on a fixed LAST_SENTENCE_IN_INTERVAL,
+// NMEAGPS can learn the sentence order of your device.  When a
+// sentence arrives with a new time, the previous sentence must have
+// been the last one in its interval.  That sentence type (and how
+// many times it was repeated, e.g., GSA) is remembered.  When the
+// same order has been seen in two intervals in a row, the following
+// intervals are completed as soon as that sentence arrives.  For
+// GSV, only the last message of each constellation is counted,
+// because the number of GSV messages changes with the satellites in
+// view (this requires NMEAGPS_PARSE_SATELLITES).
+//
+// If the device changes its sentence order, the interval is
+// completed when the new time is seen, and the new order is learned.
+// With EXPLICIT_MERGING, that late fix needs its own buffer entry, so
+// NMEAGPS_FIX_MAX should be at least 2.  LAST_SENTENCE_IN_INTERVAL is
+// only used as the initial guess.
+//
+// This requires GPS_FIX_TIME, and the first sentence in each interval
+// must contain a time field (e.g., RMC or GGA).  It cannot be used
+// with IMPLICIT_MERGING.
+
+//#define NMEAGPS_AUTO_INTERVAL
+
 //------------------------------------------------------
 // Enable/Disable coherency:
 //
@@ -126,6 +152,15 @@
   #error Only one MERGING technique should be enabled in NMEAGPS_cfg.h!
 #endif
 
+#ifdef NMEAGPS_AUTO_INTERVAL
+  #ifndef GPS_FIX_TIME
+    #error GPS_FIX_TIME must be defined in GPSfix_cfg.h to detect intervals!
+  #endif
+  #ifdef NMEAGPS_IMPLICIT_MERGING
+    #error NMEAGPS_AUTO_INTERVAL cannot be used with IMPLICIT_MERGING in NMEAGPS_cfg.h!
+  #endif
+#endif
+
 //------------------------------------------------------
 // Define the fix buffer size.  The NMEAGPS object will hold on to
 // this many fixes before an overrun occurs.  This can be zero,
@@ -213,7 +248,21 @@
 //#define NMEAGPS_PARSE_SATELLITE_INFO
 
 #ifdef NMEAGPS_PARSE_SATELLITES
-  #define NMEAGPS_MAX_SATELLITES (20)
+
+  // GSV satellites are kept in a separate block for each constellation,
+  // according to the talker ID.  Unknown talkers are kept as GPS
+  // satellites, and GSV sentences from talkers with no slots are
+  // ignored.  Set these for the constellations your receiver tracks,
+  // e.g., 16 GPS and 12 GLONASS.
+
+  #define NMEAGPS_MAX_GPS_SATELLITES     (20) // "GP"
+  #define NMEAGPS_MAX_GLONASS_SATELLITES (0)  // "GL"
+  #define NMEAGPS_MAX_GALILEO_SATELLITES (0)  // "GA"
+  #define NMEAGPS_MAX_BEIDOU_SATELLITES  (0)  // "GB" or "BD"
+
+  #define NMEAGPS_MAX_SATELLITES \
+    ( NMEAGPS_MAX_GPS_SATELLITES     + NMEAGPS_MAX_GLONASS_SATELLITES + \
+      NMEAGPS_MAX_GALILEO_SATELLITES + NMEAGPS_MAX_BEIDOU_SATELLITES )
 
   #ifndef GPS_FIX_SATELLITES
     #error GPS_FIX_SATELLITES must be defined in GPSfix.h!
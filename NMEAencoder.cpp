@@ -0,0 +1,544 @@
+/**
+ * @file NMEAencoder.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "NMEAencoder.h"
+#include "Streamers.h"
+
+//----------------------------------------------------------------
+
+static const char gga_id[] __PROGMEM = "GGA";
+static const char gll_id[] __PROGMEM = "GLL";
+static const char rmc_id[] __PROGMEM = "RMC";
+static const char vtg_id[] __PROGMEM = "VTG";
+static const char zda_id[] __PROGMEM = "ZDA";
+static const char gsa_id[] __PROGMEM = "GSA";
+static const char gsv_id[] __PROGMEM = "GSV";
+
+char *NMEAencoder::begin( char *buf, const char *id_P ) const
+{
+  buf[0] = '$';
+  buf[1] = m_talker[0];
+  buf[2] = m_talker[1];
+  memcpy_P( &buf[3], id_P, 3 );
+  buf[6] = ',';
+
+  return &buf[7];
+}
+
+//  Replace the trailing comma with the checksum and CR/LF.
+
+uint8_t NMEAencoder::finish( char *buf, char *p )
+{
+  p--;
+
+  uint8_t crc = 0;
+  for (const char *c = &buf[1]; c < p; c++)
+    crc ^= *c;
+
+  *p++ = '*';
+  uint8_t nibble = crc >> 4;
+  *p++ = (nibble < 10) ? '0' + nibble : 'A' - 10 + nibble;
+  nibble = crc & 0x0F;
+  *p++ = (nibble < 10) ? '0' + nibble : 'A' - 10 + nibble;
+  *p++ = '\r';
+  *p++ = '\n';
+
+  return p - buf;
+}
+
+//----------------------------------------------------------------
+//  Field helpers.  Each one writes its field(s) and the comma(s).
+
+static char *put_status_mode( char *p, const gps_fix &fix )
+{
+  char mode = 'N';
+  if (fix.valid.status) {
+    switch (fix.status) {
+      case gps_fix::STATUS_EST : mode = 'E'; break;
+      case gps_fix::STATUS_STD : mode = 'A'; break;
+      case gps_fix::STATUS_DGPS: mode = 'D'; break;
+      default: break;
+    }
+  }
+  *p++ = mode;
+  *p++ = ',';
+  return p;
+}
+
+static bool fix_ok( const gps_fix &fix )
+{
+  return fix.valid.status && (fix.status >= gps_fix::STATUS_STD);
+}
+
+//  "hhmmss.ss,"
+
+static char *put_time( char *p, const gps_fix &fix )
+{
+  #ifdef GPS_FIX_TIME
+    if (fix.valid.time) {
+      p    = put_2digits( p, fix.dateTime.hours );
+      p    = put_2digits( p, fix.dateTime.minutes );
+      p    = put_2digits( p, fix.dateTime.seconds );
+      *p++ = '.';
+      p    = put_2digits( p, fix.dateTime_cs );
+    }
+  #endif
+  *p++ = ',';
+  return p;
+}
+
+#ifdef GPS_FIX_LOCATION
+
+  //  "ddmm.mmmmm,N," from degrees * 1e7.  The minutes are rounded to
+  //  5 decimals, which is about 2cm.
+
+  static char *put_angle( char *p, int32_t degE7, uint8_t deg_digits, char pos, char neg )
+  {
+    char hemi = pos;
+    uint32_t u = degE7;
+    if (degE7 < 0) {
+      hemi = neg;
+      u    = -u;
+    }
+
+    uint32_t deg    = u / 10000000UL;
+    uint32_t min_e5 = ((u - deg * 10000000UL) * 6 + 5) / 10;
+    if (min_e5 >= 6000000UL) {
+      min_e5 -= 6000000UL;
+      deg++;
+    }
+    uint8_t min     = min_e5 / 100000UL;
+
+    p    = put_padded( p, deg, deg_digits );
+    p    = put_2digits( p, min );
+    *p++ = '.';
+    p    = put_padded( p, min_e5 - min * 100000UL, 5 );
+    *p++ = ',';
+    *p++ = hemi;
+    *p++ = ',';
+    return p;
+  }
+
+#endif
+
+static char *put_location( char *p, const gps_fix &fix )
+{
+  #ifdef GPS_FIX_LOCATION
+    if (fix.valid.location) {
+      p = put_angle( p, fix.latitudeL (), 2, 'N', 'S' );
+      p = put_angle( p, fix.longitudeL(), 3, 'E', 'W' );
+      return p;
+    }
+  #endif
+
+  *p++ = ',';
+  *p++ = ',';
+  *p++ = ',';
+  *p++ = ',';
+  return p;
+}
+
+static char *put_speed( char *p, const gps_fix &fix )
+{
+  #ifdef GPS_FIX_SPEED
+    if (fix.valid.speed)
+      p = put_fixed( p, fix.speed_mkn(), 3 );
+  #endif
+  *p++ = ',';
+  return p;
+}
+
+static char *put_heading( char *p, const gps_fix &fix )
+{
+  #ifdef GPS_FIX_HEADING
+    if (fix.valid.heading)
+      p = put_fixed( p, fix.heading_cd(), 2 );
+  #endif
+  *p++ = ',';
+  return p;
+}
+
+#if defined(GPS_FIX_HDOP) | defined(GPS_FIX_VDOP) | defined(GPS_FIX_PDOP)
+
+//  DOPs are stored * 1000.  All 3 decimals are written, so that they
+//  are not rounded when the sentence is parsed again.
+
+static char *put_dop( char *p, bool valid, uint16_t dop )
+{
+  if (valid)
+    p = put_fixed( p, dop, 3 );
+  *p++ = ',';
+  return p;
+}
+
+#endif
+
+//----------------------------------------------------------------
+//  $--GGA,hhmmss.ss,ddmm.mmmmm,N,dddmm.mmmmm,E,q,ss,h.hh,a.aa,M,g.gg,M,,*hh
+
+uint8_t NMEAencoder::GGA( char *buf, const gps_fix &fix ) const
+{
+  char *p = begin( buf, gga_id );
+  p = put_time( p, fix );
+  p = put_location( p, fix );
+
+  if (fix.valid.status) {
+    char quality = '0';
+    switch (fix.status) {
+      case gps_fix::STATUS_EST : quality = '6'; break;
+      case gps_fix::STATUS_STD : quality = '1'; break;
+      case gps_fix::STATUS_DGPS: quality = '2'; break;
+      default: break;
+    }
+    *p++ = quality;
+  }
+  *p++ = ',';
+
+  #ifdef GPS_FIX_SATELLITES
+    if (fix.valid.satellites)
+      p = put_padded( p, fix.satellites, (fix.satellites < 100) ? 2 : 3 );
+  #endif
+  *p++ = ',';
+
+  #ifdef GPS_FIX_HDOP
+    p = put_dop( p, fix.valid.hdop, fix.hdop );
+  #else
+    *p++ = ',';
+  #endif
+
+  #ifdef GPS_FIX_ALTITUDE
+    if (fix.valid.altitude) {
+      p    = put_fixed( p, fix.altitude_cm(), 2 );
+      *p++ = ',';
+      *p++ = 'M';
+    } else
+  #endif
+      *p++ = ',';
+  *p++ = ',';
+
+  #ifdef GPS_FIX_GEOID_HEIGHT
+    if (fix.valid.geoidHeight) {
+      p    = put_fixed( p, fix.geoidHeight_cm(), 2 );
+      *p++ = ',';
+      *p++ = 'M';
+    } else
+  #endif
+      *p++ = ',';
+  *p++ = ',';
+
+  // DGPS age and station
+  *p++ = ',';
+  *p++ = ',';
+
+  return finish( buf, p );
+
+} // GGA
+
+//----------------------------------------------------------------
+//  $--GLL,ddmm.mmmmm,N,dddmm.mmmmm,E,hhmmss.ss,A,m*hh
+
+uint8_t NMEAencoder::GLL( char *buf, const gps_fix &fix ) const
+{
+  char *p = begin( buf, gll_id );
+  p    = put_location( p, fix );
+  p    = put_time( p, fix );
+  *p++ = fix_ok( fix ) ? 'A' : 'V';
+  *p++ = ',';
+  p    = put_status_mode( p, fix );
+
+  return finish( buf, p );
+
+} // GLL
+
+//----------------------------------------------------------------
+//  $--RMC,hhmmss.ss,A,ddmm.mmmmm,N,dddmm.mmmmm,E,k.kkk,c.cc,ddmmyy,,,m*hh
+
+uint8_t NMEAencoder::RMC( char *buf, const gps_fix &fix ) const
+{
+  char *p = begin( buf, rmc_id );
+  p    = put_time( p, fix );
+  *p++ = fix_ok( fix ) ? 'A' : 'V';
+  *p++ = ',';
+  p    = put_location( p, fix );
+  p    = put_speed( p, fix );
+  p    = put_heading( p, fix );
+
+  #ifdef GPS_FIX_DATE
+    if (fix.valid.date) {
+      p = put_2digits( p, fix.dateTime.date );
+      p = put_2digits( p, fix.dateTime.month );
+      p = put_2digits( p, fix.dateTime.year );
+    }
+  #endif
+  *p++ = ',';
+
+  // Magnetic variation and direction
+  *p++ = ',';
+  *p++ = ',';
+
+  p = put_status_mode( p, fix );
+
+  return finish( buf, p );
+
+} // RMC
+
+//----------------------------------------------------------------
+//  $--VTG,c.cc,T,,M,k.kkk,N,k.kkk,K,m*hh
+
+uint8_t NMEAencoder::VTG( char *buf, const gps_fix &fix ) const
+{
+  char *p = begin( buf, vtg_id );
+
+  p = put_heading( p, fix );
+  *p++ = 'T';
+  *p++ = ',';
+  *p++ = ',';
+  *p++ = 'M';
+  *p++ = ',';
+
+  p = put_speed( p, fix );
+  *p++ = 'N';
+  *p++ = ',';
+
+  #ifdef GPS_FIX_SPEED
+    if (fix.valid.speed) {
+      // meters per hour is km/h with 3 decimals.  The whole knots are
+      //   converted separately, so the product fits in 32 bits.
+      uint32_t mkn   = fix.speed_mkn();
+      uint32_t knots = mkn / 1000;
+      uint32_t mph   = knots * gps_fix::M_PER_NMI +
+                       ((mkn - knots*1000) * gps_fix::M_PER_NMI + 500) / 1000;
+      p = put_fixed( p, mph, 3 );
+    }
+  #endif
+  *p++ = ',';
+  *p++ = 'K';
+  *p++ = ',';
+
+  p = put_status_mode( p, fix );
+
+  return finish( buf, p );
+
+} // VTG
+
+//----------------------------------------------------------------
+//  $--ZDA,hhmmss.ss,dd,mm,yyyy,,*hh
+
+uint8_t NMEAencoder::ZDA( char *buf, const gps_fix &fix ) const
+{
+  char *p = begin( buf, zda_id );
+  p = put_time( p, fix );
+
+  #ifdef GPS_FIX_DATE
+    if (fix.valid.date) {
+      uint16_t year    = fix.dateTime.full_year();
+      uint8_t  century = year / 100;
+
+      p    = put_2digits( p, fix.dateTime.date );
+      *p++ = ',';
+      p    = put_2digits( p, fix.dateTime.month );
+      *p++ = ',';
+      p    = put_2digits( p, century );
+      p    = put_2digits( p, year - century*100 );
+      *p++ = ',';
+    } else
+  #endif
+    {
+      *p++ = ',';
+      *p++ = ',';
+      *p++ = ',';
+    }
+
+  // Local zone hours and minutes
+  *p++ = ',';
+  *p++ = ',';
+
+  return finish( buf, p );
+
+} // ZDA
+
+//----------------------------------------------------------------
+//  $--GSA,A,3,ss,ss,ss,ss,ss,ss,ss,ss,ss,ss,ss,ss,p.pp,h.hh,v.vv*hh
+
+#ifdef NMEAGPS_PARSE_SATELLITES
+
+uint8_t NMEAencoder::GSA( char *buf, const gps_fix &fix, const NMEAGPS &gps ) const
+{
+  char *p = begin( buf, gsa_id );
+  *p++ = 'A';
+  *p++ = ',';
+  *p++ = fix_ok( fix ) ? '3' : '1';
+  *p++ = ',';
+
+  uint8_t used = 0;
+  for (uint8_t i=0; (i < gps.sat_count) && (used < 12); i++) {
+    #ifdef NMEAGPS_PARSE_SATELLITE_INFO
+      if (!gps.satellites[i].tracked)
+        continue;
+    #endif
+    p    = put_padded( p, gps.satellites[i].id, (gps.satellites[i].id < 100) ? 2 : 3 );
+    *p++ = ',';
+    used++;
+  }
+  while (used++ < 12)
+    *p++ = ',';
+
+  #ifdef GPS_FIX_PDOP
+    p = put_dop( p, fix.valid.pdop, fix.pdop );
+  #else
+    *p++ = ',';
+  #endif
+  #ifdef GPS_FIX_HDOP
+    p = put_dop( p, fix.valid.hdop, fix.hdop );
+  #else
+    *p++ = ',';
+  #endif
+  #ifdef GPS_FIX_VDOP
+    p = put_dop( p, fix.valid.vdop, fix.vdop );
+  #else
+    *p++ = ',';
+  #endif
+
+  return finish( buf, p );
+
+} // GSA
+
+#endif
+
+//----------------------------------------------------------------
+//  $--GSV,n,m,ss,{id,ee,aaa,nn}*hh
+//
+//  Each constellation with satellites is a separate GSV set, with its
+//  own talker ID and message numbers.  Satellites that were not
+//  received by GSV (e.g., from ublox SVINFO) are one set with the
+//  talker ID of the encoder.
+
+#ifdef NMEAGPS_PARSE_SATELLITE_INFO
+
+#ifdef NMEAGPS_PARSE_GSV
+  //  Talker IDs, in NMEAGPS::constellation_t order
+  static const char gsv_talkers[] __PROGMEM = "GPGLGAGB";
+#endif
+
+struct gsv_set_t {
+  uint8_t start; // index of its first satellite
+  uint8_t count; // satellites in the set
+  uint8_t msgs;  // GSV messages in the set
+  uint8_t msg;   // the requested message, 1..msgs
+  int8_t  con;   // constellation_t, or -1 for the encoder's talker ID
+};
+
+static uint8_t gsv_msgs( uint8_t count )
+{
+  return (count == 0) ? 1 : (count + 3) / 4;
+}
+
+//  Find the set of message /msg_no/, counting from the first message of
+//  the first set.  Returns the number of messages in all sets.
+
+static uint8_t gsv_find( const NMEAGPS &gps, uint8_t msg_no, gsv_set_t & set )
+{
+  set.start = 0;
+  set.count = gps.sat_count;
+  set.msgs  = gsv_msgs( gps.sat_count );
+  set.msg   = msg_no;
+  set.con   = -1;
+
+  #ifdef NMEAGPS_PARSE_GSV
+    uint8_t   total = 0;
+    uint8_t   start = 0;
+    gsv_set_t found = set;
+
+    for (uint8_t c=0; c < NMEAGPS::GNSS_COUNT; c++) {
+      uint8_t count = gps.constellation_count( (NMEAGPS::constellation_t) c );
+      if (count == 0)
+        continue;
+
+      uint8_t msgs = gsv_msgs( count );
+      if ((total < msg_no) && (msg_no <= total + msgs)) {
+        found.start = start;
+        found.count = count;
+        found.msgs  = msgs;
+        found.msg   = msg_no - total;
+        found.con   = c;
+      }
+      total += msgs;
+      start += count;
+    }
+
+    //  Use the constellation blocks only if they hold every satellite.
+    if (total && (start == gps.sat_count)) {
+      set = found;
+      return total;
+    }
+  #endif
+
+  return set.msgs;
+
+} // gsv_find
+
+uint8_t NMEAencoder::GSV_count( const NMEAGPS &gps )
+{
+  gsv_set_t set;
+  return gsv_find( gps, 0, set );
+}
+
+uint8_t NMEAencoder::GSV( char *buf, const NMEAGPS &gps, uint8_t msg_no ) const
+{
+  gsv_set_t set;
+  gsv_find( gps, msg_no, set );
+
+  char *p = begin( buf, gsv_id );
+  #ifdef NMEAGPS_PARSE_GSV
+    if (set.con >= 0) {
+      buf[1] = pgm_read_byte( &gsv_talkers[ 2*set.con   ] );
+      buf[2] = pgm_read_byte( &gsv_talkers[ 2*set.con+1 ] );
+    }
+  #endif
+
+  p    = put_u16( p, set.msgs );
+  *p++ = ',';
+  p    = put_u16( p, set.msg );
+  *p++ = ',';
+  p    = put_padded( p, set.count, (set.count < 100) ? 2 : 3 );
+  *p++ = ',';
+
+  uint8_t i   = set.start + (set.msg - 1) * 4;
+  uint8_t end = i + 4;
+  if (end > set.start + set.count)
+    end = set.start + set.count;
+
+  for (; i < end; i++) {
+    const NMEAGPS::satellite_view_t & sat = gps.satellites[i];
+
+    p    = put_padded( p, sat.id, (sat.id < 100) ? 2 : 3 );
+    *p++ = ',';
+    p    = put_padded( p, sat.elevation, 2 );
+    *p++ = ',';
+    p    = put_padded( p, sat.azimuth, 3 );
+    *p++ = ',';
+    if (sat.tracked)
+      p = put_padded( p, sat.snr, 2 );
+    *p++ = ',';
+  }
+
+  return finish( buf, p );
+
+} // GSV
+
+#endif
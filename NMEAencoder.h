@@ -0,0 +1,93 @@
+#ifndef NMEAENCODER_H
+#define NMEAENCODER_H
+
+/**
+ * @file NMEAencoder.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "NMEAGPS.h"
+
+/**
+ * Render a gps_fix (and the NMEAGPS satellite array) as standard
+ * NMEA 0183 sentences, for relaying filtered or fused fixes to
+ * equipment that only understands NMEA.
+ *
+ * Each method writes one complete sentence into /buf/: the '$', the
+ * talker and sentence IDs, the fields, the "*HH" checksum and CR/LF.
+ * Members that are not configured or not valid become empty fields.
+ * The buffer is not NUL-terminated; the return value is its length.
+ * Write it with one call, e.g. "port.write( buf, len )".
+ *
+ * Locations are "ddmm.mmmmm", times are "hhmmss.ss", speeds are knots
+ * and km/h, altitudes and courses have two decimals, and DOPs have
+ * three.
+ */
+
+class NMEAencoder
+{
+public:
+
+  /**
+   * The NMEA limit is 82 characters.  Only GGA can exceed it, with
+   * unusual values: 100 or more satellites, an HDOP over 10, and
+   * altitudes or geoid heights below -10km.  The longest GGA is 87
+   * characters, plus room for a NUL terminator.
+   */
+  static const uint8_t MAX_LENGTH = 88;
+
+  /**
+   * Constructor.
+   * @param[in] talker two-character talker ID (e.g., "GP" or "GN").
+   */
+  explicit NMEAencoder( const char *talker = "GP" )
+    { m_talker[0] = talker[0]; m_talker[1] = talker[1]; }
+
+  uint8_t GGA( char *buf, const gps_fix &fix ) const;
+  uint8_t GLL( char *buf, const gps_fix &fix ) const;
+  uint8_t RMC( char *buf, const gps_fix &fix ) const;
+  uint8_t VTG( char *buf, const gps_fix &fix ) const;
+  uint8_t ZDA( char *buf, const gps_fix &fix ) const;
+
+  #ifdef NMEAGPS_PARSE_SATELLITES
+    /**
+     * The satellite IDs are the tracked satellites (or all satellites,
+     * if SATELLITE_INFO is not parsed), up to 12.
+     */
+    uint8_t GSA( char *buf, const gps_fix &fix, const NMEAGPS &gps ) const;
+  #endif
+
+  #ifdef NMEAGPS_PARSE_SATELLITE_INFO
+    /**
+     * Render one GSV sentence.  Each constellation is a separate GSV
+     * set, with its own talker ID ("GP", "GL", "GA" or "GB") and
+     * message numbers.
+     * @param[in] msg_no 1..GSV_count( gps ), for all the sets.
+     */
+    uint8_t GSV( char *buf, const NMEAGPS &gps, uint8_t msg_no ) const;
+
+    //  The number of GSV sentences in all the sets.
+    static uint8_t GSV_count( const NMEAGPS &gps );
+  #endif
+
+protected:
+  char m_talker[2];
+
+  char   *begin ( char *buf, const char *id_P ) const;
+  static uint8_t finish( char *buf, char *p );
+};
+
+#endif
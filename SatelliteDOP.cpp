@@ -0,0 +1,256 @@
+/**
+ * @file SatelliteDOP.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "SatelliteDOP.h"
+
+#ifdef NMEAGPS_PARSE_SATELLITE_INFO
+
+#include <math.h>
+
+//------------------------------------------------------------------
+//  Elevations and azimuths are whole degrees, so a table is faster
+//  (and smaller) than the float sin/cos functions.  sin(deg) * 65535
+
+static const uint16_t sin_table[91] __PROGMEM =
+  {
+        0,  1144,  2287,  3430,  4571,  5712,  6850,  7987,  9121, 10252,
+    11380, 12505, 13625, 14742, 15854, 16962, 18064, 19161, 20251, 21336,
+    22414, 23486, 24550, 25607, 26655, 27696, 28729, 29752, 30767, 31772,
+    32767, 33753, 34728, 35693, 36647, 37589, 38521, 39440, 40347, 41243,
+    42125, 42995, 43851, 44695, 45524, 46340, 47142, 47929, 48702, 49460,
+    50203, 50930, 51642, 52339, 53019, 53683, 54331, 54962, 55577, 56174,
+    56755, 57318, 57864, 58392, 58902, 59395, 59869, 60325, 60763, 61182,
+    61583, 61965, 62327, 62671, 62996, 63302, 63588, 63855, 64103, 64331,
+    64539, 64728, 64897, 65047, 65176, 65286, 65375, 65445, 65495, 65525,
+    65535
+  };
+
+static float sin_deg( uint16_t deg ) // 0..359
+{
+  bool negative = (deg >= 180);
+  if (negative)
+    deg -= 180;
+  if (deg > 90)
+    deg = 180 - deg;
+
+  float s = pgm_read_word( &sin_table[ deg ] ) * (1.0 / 65535.0);
+  return negative ? -s : s;
+}
+
+static float cos_deg( uint16_t deg )
+{
+  deg += 90;
+  if (deg >= 360)
+    deg -= 360;
+  return sin_deg( deg );
+}
+
+//------------------------------------------------------------------
+
+SatelliteDOP::mask_t SatelliteDOP::set( const NMEAGPS & gps )
+{
+  m_usable = 0;
+
+  uint8_t count = gps.sat_count;
+  if (count > SATELLITE_DOP_MAX)
+    count = SATELLITE_DOP_MAX;
+
+  for (uint8_t i=0; i < count; i++) {
+    const NMEAGPS::satellite_view_t & sat = gps.satellites[i];
+
+    if (!sat.tracked || (sat.elevation > 90) || (sat.azimuth >= 360))
+      continue;
+
+    float cos_el = cos_deg( sat.elevation );
+    m_los[i][0]    = cos_el * sin_deg( sat.azimuth );
+    m_los[i][1]    = cos_el * cos_deg( sat.azimuth );
+    m_los[i][2]    = sin_deg( sat.elevation );
+    m_elevation[i] = sat.elevation;
+    m_usable      |= ((mask_t) 1) << i;
+  }
+
+  return m_usable;
+
+} // set
+
+//------------------------------------------------------------------
+
+SatelliteDOP::mask_t SatelliteDOP::above( uint8_t elevation ) const
+{
+  mask_t mask = 0;
+
+  for (uint8_t i=0; i < SATELLITE_DOP_MAX; i++) {
+    mask_t bit = ((mask_t) 1) << i;
+    if ((m_usable & bit) && (m_elevation[i] >= elevation))
+      mask |= bit;
+  }
+
+  return mask;
+}
+
+//------------------------------------------------------------------
+
+#ifdef NMEAGPS_PARSE_GSV
+
+SatelliteDOP::mask_t SatelliteDOP::constellation
+  ( const NMEAGPS & gps, NMEAGPS::constellation_t c ) const
+{
+  uint8_t start = gps.constellation_start( c );
+  uint8_t end   = start + gps.constellation_count( c );
+  if (end > SATELLITE_DOP_MAX)
+    end = SATELLITE_DOP_MAX;
+
+  mask_t mask = 0;
+  for (uint8_t i=start; i < end; i++)
+    mask |= ((mask_t) 1) << i;
+
+  return mask & m_usable;
+}
+
+#endif
+
+//------------------------------------------------------------------
+//  Each satellite contributes a row (-e, -n, -u, 1) to the geometry
+//  matrix G.  The normal matrix N = GtG is symmetric, so only its
+//  lower triangle is accumulated.  The DOPs come from the diagonal of
+//  its inverse, which is found with a Cholesky factorization, N = LLt:
+//  the inverse is MtM, where M is the inverse of L.
+
+bool SatelliteDOP::cofactors( float q[4], mask_t mask ) const
+{
+  float   n[4][4];
+  uint8_t count = 0;
+
+  for (uint8_t r=0; r < 4; r++)
+    for (uint8_t c=0; c <= r; c++)
+      n[r][c] = 0.0;
+
+  mask &= m_usable;
+  for (uint8_t i=0; mask; i++, mask >>= 1) {
+    if (!(mask & 1))
+      continue;
+
+    float east  = m_los[i][0];
+    float north = m_los[i][1];
+    float up    = m_los[i][2];
+    n[0][0] += east  * east;
+    n[1][0] += north * east;
+    n[1][1] += north * north;
+    n[2][0] += up    * east;
+    n[2][1] += up    * north;
+    n[2][2] += up    * up;
+    n[3][0] -= east;
+    n[3][1] -= north;
+    n[3][2] -= up;
+    count++;
+  }
+
+  if (count < 4)
+    return false;
+  n[3][3] = count;
+
+  //  Factor in place: the lower triangle of n becomes L.
+
+  for (uint8_t c=0; c < 4; c++) {
+    float d = n[c][c];
+    for (uint8_t k=0; k < c; k++)
+      d -= n[c][k] * n[c][k];
+    if (d <= 1.0e-6 * count)
+      return false; // singular, or nearly so
+
+    d = sqrt( d );
+    n[c][c] = d;
+    for (uint8_t r=c+1; r < 4; r++) {
+      float s = n[r][c];
+      for (uint8_t k=0; k < c; k++)
+        s -= n[r][k] * n[c][k];
+      n[r][c] = s / d;
+    }
+  }
+
+  //  Invert L, one column at a time, and sum the squares of each column.
+
+  for (uint8_t c=0; c < 4; c++) {
+    float m[4];
+    m[c] = 1.0 / n[c][c];
+    float sum = m[c] * m[c];
+    for (uint8_t r=c+1; r < 4; r++) {
+      float s = 0.0;
+      for (uint8_t k=c; k < r; k++)
+        s -= n[r][k] * m[k];
+      m[r] = s / n[r][r];
+      sum += m[r] * m[r];
+    }
+    q[c] = sum;
+  }
+
+  return true;
+
+} // cofactors
+
+//------------------------------------------------------------------
+
+static uint16_t dop_1000( float variance )
+{
+  float dop = sqrt( variance ) * 1000.0 + 0.5;
+  return (dop < 65535.0) ? (uint16_t) dop : 65535;
+}
+
+bool SatelliteDOP::compute( dop_t & dop, mask_t mask ) const
+{
+  float q[4];
+
+  if (!cofactors( q, mask ))
+    return false;
+
+  float horizontal = q[0] + q[1];
+  dop.hdop = dop_1000( horizontal );
+  dop.vdop = dop_1000( q[2] );
+  dop.pdop = dop_1000( horizontal + q[2] );
+  dop.tdop = dop_1000( q[3] );
+  dop.gdop = dop_1000( horizontal + q[2] + q[3] );
+
+  return true;
+}
+
+//------------------------------------------------------------------
+
+bool SatelliteDOP::compute( gps_fix & fix, mask_t mask ) const
+{
+  dop_t dop;
+
+  if (!compute( dop, mask ))
+    return false;
+
+  #ifdef GPS_FIX_HDOP
+    fix.hdop       = dop.hdop;
+    fix.valid.hdop = true;
+  #endif
+  #ifdef GPS_FIX_VDOP
+    fix.vdop       = dop.vdop;
+    fix.valid.vdop = true;
+  #endif
+  #ifdef GPS_FIX_PDOP
+    fix.pdop       = dop.pdop;
+    fix.valid.pdop = true;
+  #endif
+
+  return true;
+}
+
+#endif
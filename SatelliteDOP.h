@@ -0,0 +1,109 @@
+#ifndef SATELLITEDOP_H
+#define SATELLITEDOP_H
+
+/**
+ * @file SatelliteDOP.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "NMEAGPS.h"
+
+#ifdef NMEAGPS_PARSE_SATELLITE_INFO
+
+//------------------------------------------------------------------
+//  Dilution of Precision computed from the elevation and azimuth of
+//  the satellites, instead of the DOPs reported by the receiver.
+//
+//  /set/ converts the tracked satellites of an NMEAGPS satellite array
+//  to line-of-sight vectors, once per epoch.  DOPs can then be computed
+//  for any subset of those satellites (a "mask"), without any
+//  trigonometry: each subset is a 4x4 least-squares solution (east,
+//  north, up and clock), which only needs a few float operations per
+//  satellite.  This makes it cheap to ask "what if" questions, like the
+//  DOP without the satellites below 15 degrees, or without GLONASS.
+//
+//  Bit i of a mask is gps.satellites[i].  Only the first
+//  SATELLITE_DOP_MAX satellites can be used (at most 32).  Each one
+//  uses 13 bytes of RAM.
+
+#if NMEAGPS_MAX_SATELLITES < 32
+  #define SATELLITE_DOP_MAX NMEAGPS_MAX_SATELLITES
+#else
+  #define SATELLITE_DOP_MAX 32
+#endif
+
+class SatelliteDOP
+{
+public:
+  typedef uint32_t mask_t;
+
+  //  Same scale as the gps_fix DOP members: DOP * 1000
+  struct dop_t {
+    uint16_t gdop;
+    uint16_t pdop;
+    uint16_t hdop;
+    uint16_t vdop;
+    uint16_t tdop;
+  };
+
+  SatelliteDOP() : m_usable( 0 ) {}
+
+  /**
+   * Load the geometry of the tracked satellites.  Call this when the
+   * satellite array is complete (e.g., gps.satellites_complete()).
+   * @return the mask of the usable satellites.
+   */
+  mask_t set( const NMEAGPS & gps );
+
+  mask_t usable() const { return m_usable; }
+
+  //  The usable satellites at or above an elevation mask (degrees).
+  mask_t above( uint8_t elevation ) const;
+
+  #ifdef NMEAGPS_PARSE_GSV
+    //  The usable satellites of one constellation.
+    mask_t constellation( const NMEAGPS & gps,
+                          NMEAGPS::constellation_t c ) const;
+  #endif
+
+  /**
+   * Compute the DOPs of the usable satellites in /mask/.
+   * @return false if there are fewer than 4 satellites, or if their
+   *   geometry does not have a solution (e.g., all in one plane).
+   */
+  bool compute( dop_t & dop, mask_t mask ) const;
+  bool compute( dop_t & dop ) const { return compute( dop, m_usable ); }
+
+  /**
+   * Set the configured DOP members of /fix/ (and their valid flags)
+   * from the geometry of the satellites in /mask/.
+   */
+  bool compute( gps_fix & fix, mask_t mask ) const;
+  bool compute( gps_fix & fix ) const { return compute( fix, m_usable ); }
+
+protected:
+  float   m_los[ SATELLITE_DOP_MAX ][3]; // east, north, up unit vectors
+  uint8_t m_elevation[ SATELLITE_DOP_MAX ];
+  mask_t  m_usable;
+
+  //  The diagonal of the inverse normal matrix: east, north, up, clock.
+  //  Returns false if the matrix is singular.
+  bool cofactors( float q[4], mask_t mask ) const;
+};
+
+#endif
+
+#endif
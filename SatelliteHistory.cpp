@@ -0,0 +1,188 @@
+/**
+ * @file SatelliteHistory.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "SatelliteHistory.h"
+
+#ifdef NMEAGPS_PARSE_SATELLITE_INFO
+
+//------------------------------------------------------------------
+
+void SatelliteHistory::init()
+{
+  memset( m_snr      , 0, sizeof(m_snr) );
+  memset( m_elevation, 0, sizeof(m_elevation) );
+  memset( m_tracked  , 0, sizeof(m_tracked) );
+  memset( m_reported , 0, sizeof(m_reported) );
+  memset( m_snr_sum  , 0, sizeof(m_snr_sum) );
+  memset( m_time     , 0, sizeof(m_time) );
+  m_head   = EPOCHS-1;
+  m_epochs = 0;
+  dropped  = 0;
+}
+
+//------------------------------------------------------------------
+
+uint8_t SatelliteHistory::find( uint8_t id, uint8_t gnss ) const
+{
+  for (uint8_t slot=0; slot < SLOTS; slot++)
+    if (m_reported[slot] && (m_id[slot] == id) && (m_gnss[slot] == gnss))
+      return slot;
+
+  return SLOTS;
+}
+
+//------------------------------------------------------------------
+
+void SatelliteHistory::update( const NMEAGPS & gps, uint32_t time_ms )
+{
+  //  Start a new epoch in the oldest sample.
+
+  m_head = (m_head == EPOCHS-1) ? 0 : m_head+1;
+  m_time[ m_head ] = time_ms;
+  if (m_epochs < EPOCHS)
+    m_epochs++;
+
+  const mask_t all = window( EPOCHS );
+  for (uint8_t slot=0; slot < SLOTS; slot++) {
+    m_snr_sum  [slot]         -= m_snr[slot][ m_head ];
+    m_snr      [slot][ m_head ] = 0;
+    m_elevation[slot][ m_head ] = 0;
+    m_tracked  [slot]          = (m_tracked [slot] << 1) & all;
+    m_reported [slot]          = (m_reported[slot] << 1) & all;
+  }
+
+  //  Add the current satellites.  GSV satellites are grouped by
+  //  constellation; satellites that were not received by GSV (e.g.,
+  //  ublox SVINFO) are all GPS (0).
+
+  #ifdef NMEAGPS_PARSE_GSV
+    uint8_t block     = 0;
+    uint8_t block_end = gps.constellation_count( (NMEAGPS::constellation_t) 0 );
+  #endif
+
+  for (uint8_t i=0; i < gps.sat_count; i++) {
+    const NMEAGPS::satellite_view_t & sat = gps.satellites[i];
+
+    uint8_t gnss = 0;
+    #ifdef NMEAGPS_PARSE_GSV
+      while ((i >= block_end) && (block < NMEAGPS::GNSS_COUNT-1)) {
+        block++;
+        block_end += gps.constellation_count( (NMEAGPS::constellation_t) block );
+      }
+      if (i < block_end)
+        gnss = block;
+    #endif
+
+    uint8_t slot = find( sat.id, gnss );
+    if (slot == SLOTS) {
+      for (slot=0; slot < SLOTS; slot++)
+        if (!m_reported[slot])
+          break;
+      if (slot == SLOTS) {
+        dropped++;
+        continue;
+      }
+      m_id  [slot] = sat.id;
+      m_gnss[slot] = gnss;
+    }
+
+    m_reported [slot]         |= 1;
+    m_elevation[slot][ m_head ] = sat.elevation;
+    if (sat.tracked) {
+      m_tracked[slot]         |= 1;
+      m_snr    [slot][ m_head ] = sat.snr;
+      m_snr_sum[slot]         += sat.snr;
+    }
+  }
+
+} // update
+
+//------------------------------------------------------------------
+
+uint8_t SatelliteHistory::tracked_count( uint8_t slot, uint8_t n ) const
+{
+  uint8_t count = 0;
+  for (mask_t tracked = m_tracked[slot] & window( n ); tracked; tracked >>= 1)
+    count += (tracked & 1);
+
+  return count;
+}
+
+uint8_t SatelliteHistory::mean_snr( uint8_t slot ) const
+{
+  uint8_t count = tracked_count( slot );
+  if (count == 0)
+    return 0;
+
+  return (m_snr_sum[slot] + count/2) / count;
+}
+
+uint8_t SatelliteHistory::mean_snr( uint8_t slot, uint8_t n ) const
+{
+  if (n > m_epochs)
+    n = m_epochs;
+
+  uint16_t sum   = 0;
+  uint8_t  count = 0;
+  mask_t   tracked = m_tracked[slot];
+  for (uint8_t age=0; age < n; age++, tracked >>= 1) {
+    if (tracked & 1) {
+      sum += snr( slot, age );
+      count++;
+    }
+  }
+
+  return count ? (sum + count/2) / count : 0;
+}
+
+uint8_t SatelliteHistory::min_snr( uint8_t slot, uint8_t n ) const
+{
+  if (n > m_epochs)
+    n = m_epochs;
+
+  uint8_t min     = 0;
+  bool    found   = false;
+  mask_t  tracked = m_tracked[slot];
+  for (uint8_t age=0; age < n; age++, tracked >>= 1) {
+    if (tracked & 1) {
+      uint8_t s = snr( slot, age );
+      if (!found || (s < min)) {
+        min   = s;
+        found = true;
+      }
+    }
+  }
+
+  return min;
+}
+
+uint8_t SatelliteHistory::max_snr( uint8_t slot, uint8_t n ) const
+{
+  if (n > m_epochs)
+    n = m_epochs;
+
+  uint8_t max     = 0;
+  mask_t  tracked = m_tracked[slot];
+  for (uint8_t age=0; age < n; age++, tracked >>= 1)
+    if ((tracked & 1) && (snr( slot, age ) > max))
+      max = snr( slot, age );
+
+  return max;
+}
+
+#endif
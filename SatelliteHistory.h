@@ -0,0 +1,156 @@
+#ifndef SATELLITEHISTORY_H
+#define SATELLITEHISTORY_H
+
+/**
+ * @file SatelliteHistory.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "NMEAGPS.h"
+
+#ifdef NMEAGPS_PARSE_SATELLITE_INFO
+
+//------------------------------------------------------------------
+//  The recent signal history of each satellite, for detecting
+//  antenna or receiver problems from the C/N0 trend.
+//
+//  Each call to /update/ records one epoch of the NMEAGPS satellite
+//  array: the SNR (C/N0), elevation and tracked state of every
+//  satellite, and a timestamp for the epoch.  The last
+//  SAT_HISTORY_EPOCHS epochs are kept for up to SAT_HISTORY_SATELLITES
+//  satellites.  A satellite keeps its slot while it was reported in
+//  any epoch of the window; the slot is reused when it has aged out.
+//
+//  The samples are kept in separate arrays (structure of arrays), so
+//  that a statistic over one satellite's history is a scan of a few
+//  contiguous bytes.  The tracked and reported states are bit masks
+//  where bit 0 is the latest epoch, so "tracked in the last N epochs"
+//  is a mask.  A running sum gives the mean C/N0 over the whole window
+//  without scanning.
+//
+//  Each satellite uses 2 * SAT_HISTORY_EPOCHS + 4 bytes, plus two
+//  masks of up to 4 bytes each.
+
+#ifndef SAT_HISTORY_SATELLITES
+  #define SAT_HISTORY_SATELLITES NMEAGPS_MAX_SATELLITES
+#endif
+
+#ifndef SAT_HISTORY_EPOCHS
+  #define SAT_HISTORY_EPOCHS 8
+#endif
+
+#if (SAT_HISTORY_EPOCHS < 1) | (SAT_HISTORY_EPOCHS > 32)
+  #error SAT_HISTORY_EPOCHS must be 1..32!
+#endif
+
+class SatelliteHistory
+{
+public:
+
+  #if SAT_HISTORY_EPOCHS <= 8
+    typedef uint8_t  mask_t;
+  #elif SAT_HISTORY_EPOCHS <= 16
+    typedef uint16_t mask_t;
+  #else
+    typedef uint32_t mask_t;
+  #endif
+
+  static const uint8_t SLOTS  = SAT_HISTORY_SATELLITES;
+  static const uint8_t EPOCHS = SAT_HISTORY_EPOCHS;
+
+  SatelliteHistory() { init(); }
+  void init();
+
+  /**
+   * Record the current satellite array as the latest epoch.  Call this
+   * once per epoch, when the array is complete (e.g., when
+   * gps.satellites_complete() becomes true).
+   * @param[in] time_ms timestamp of the epoch (e.g., millis()).
+   */
+  void update( const NMEAGPS & gps, uint32_t time_ms );
+
+  //  The number of epochs in the window, up to EPOCHS.
+  uint8_t epochs() const { return m_epochs; }
+
+  //  The timestamp of an epoch.  Age 0 is the latest.
+  uint32_t time( uint8_t age ) const { return m_time[ index( age ) ]; }
+
+  //  Satellites that were dropped because all slots were in use.
+  uint16_t dropped;
+
+  //  The slot of a satellite, or SLOTS if it is not in the window.
+  //  For GSV satellites, /gnss/ is the NMEAGPS::constellation_t.
+  uint8_t find( uint8_t id, uint8_t gnss = 0 ) const;
+
+  //  Slot contents
+  bool    active( uint8_t slot ) const { return (m_reported[slot] != 0); }
+  uint8_t id    ( uint8_t slot ) const { return m_id  [slot]; }
+  uint8_t gnss  ( uint8_t slot ) const { return m_gnss[slot]; }
+
+  //  Samples by age (0 is the latest).  Epochs when a satellite was
+  //  not tracked have an SNR of 0.  Epochs when it was not reported
+  //  also have an elevation of 0.
+  uint8_t snr      ( uint8_t slot, uint8_t age ) const
+    { return m_snr[slot][ index( age ) ]; }
+  uint8_t elevation( uint8_t slot, uint8_t age ) const
+    { return m_elevation[slot][ index( age ) ]; }
+  bool    tracked  ( uint8_t slot, uint8_t age ) const
+    { return (m_tracked[slot] >> age) & 1; }
+  bool    reported ( uint8_t slot, uint8_t age ) const
+    { return (m_reported[slot] >> age) & 1; }
+
+  //  Bit /age/ is set if the satellite was tracked in that epoch.
+  mask_t  tracked_mask ( uint8_t slot ) const { return m_tracked [slot]; }
+  mask_t  reported_mask( uint8_t slot ) const { return m_reported[slot]; }
+
+  //  Rolling statistics over the tracked samples of the last /n/
+  //  epochs.  The means are rounded, and are 0 if there are no samples.
+  uint8_t tracked_count( uint8_t slot, uint8_t n = EPOCHS ) const;
+  uint8_t mean_snr     ( uint8_t slot ) const; // whole window, no scan
+  uint8_t mean_snr     ( uint8_t slot, uint8_t n ) const;
+  uint8_t min_snr      ( uint8_t slot, uint8_t n = EPOCHS ) const;
+  uint8_t max_snr      ( uint8_t slot, uint8_t n = EPOCHS ) const;
+
+protected:
+  //  Samples, one array per member
+  uint8_t  m_snr      [ SLOTS ][ EPOCHS ];
+  uint8_t  m_elevation[ SLOTS ][ EPOCHS ];
+  mask_t   m_tracked  [ SLOTS ];
+  mask_t   m_reported [ SLOTS ];
+  uint16_t m_snr_sum  [ SLOTS ]; // of the whole window
+  uint8_t  m_id       [ SLOTS ];
+  uint8_t  m_gnss     [ SLOTS ];
+
+  uint32_t m_time[ EPOCHS ];
+  uint8_t  m_head;               // index of the latest epoch
+  uint8_t  m_epochs;
+
+  uint8_t index( uint8_t age ) const
+    { return (m_head >= age) ? m_head - age : m_head + EPOCHS - age; }
+
+  static mask_t window( uint8_t n )
+    {
+      if (n == 0)
+        return 0;
+      if (n > EPOCHS)
+        n = EPOCHS;
+      return (mask_t) ((((mask_t) 1 << (n-1)) << 1) - 1);
+    }
+};
+
+#endif
+
+#endif
@@ -96,46 +96,166 @@ const char gps_fix_header[] __PROGMEM =
     "Sats,"
   #endif
 
+  #if defined(GPS_FIX_RX_TIME)
+    "Xfer us,Parse us,Queue us,"
+  #endif
+
   ;
 
+//...............
+//  Integer-to-decimal conversion into a character buffer.  Digits are
+//  generated in pairs by put_2digits (see Time.h), which halves the
+//  number of divisions.  Values that fit in 16 bits avoid the (slow)
+//  32-bit division on 8-bit MCUs.
+
+char *put_u16( char *p, uint16_t v )
+{
+  char  digits[5];
+  char *d = &digits[ sizeof(digits) ];
+
+  while (v >= 100) {
+    uint16_t q = v / 100;
+    d -= 2;
+    put_2digits( d, v - q*100 );
+    v  = q;
+  }
+  if (v >= 10) {
+    d -= 2;
+    put_2digits( d, v );
+  } else
+    *--d = '0' + v;
+
+  uint8_t len = &digits[ sizeof(digits) ] - d;
+  memcpy( p, d, len );
+  return p + len;
+}
+
+char *put_u32( char *p, uint32_t v )
+{
+  if (v <= 0xFFFF)
+    return put_u16( p, v );
+
+  char  digits[10];
+  char *d = &digits[ sizeof(digits) ];
+
+  while (v > 0xFFFF) {
+    uint32_t q = v / 100;
+    d -= 2;
+    put_2digits( d, v - q*100 );
+    v  = q;
+  }
+  p = put_u16( p, v );
+
+  uint8_t len = &digits[ sizeof(digits) ] - d;
+  memcpy( p, d, len );
+  return p + len;
+}
+
+char *put_i32( char *p, int32_t v )
+{
+  uint32_t u = v;
+  if (v < 0) {
+    *p++ = '-';
+    u    = -u;
+  }
+  return put_u32( p, u );
+}
+
+char *put_padded( char *p, uint32_t v, uint8_t width )
+{
+  char *end = p + width;
+  char *d   = end;
+
+  while (d - p >= 2) {
+    uint32_t q = v / 100;
+    d -= 2;
+    put_2digits( d, v - q*100 );
+    v  = q;
+  }
+  if (d > p)
+    *--d = '0' + v;
+
+  return end;
+}
+
+static const uint32_t powers_of_10[] __PROGMEM =
+  { 1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL,
+    100000000UL };
+
+char *put_fixed( char *p, int32_t v, uint8_t decimals )
+{
+  uint32_t u = v;
+  if (v < 0) {
+    *p++ = '-';
+    u    = -u;
+  }
+
+  uint32_t scale = pgm_read_dword( &powers_of_10[ decimals ] );
+  uint32_t whole = u / scale;
+
+  p    = put_u32( p, whole );
+  if (decimals == 0)
+    return p;
+
+  *p++ = '.';
+  return put_padded( p, u - whole*scale, decimals );
+}
+
 //...............
 
 #ifdef GPS_FIX_LOCATION_DMS
 
-  static void printDMS( Print & outs, const DMS_t & dms )
+  static char *putDMS( char *p, const DMS_t & dms )
   {
     if (dms.degrees < 10)
-      outs.write( '0' );
-    outs.print( dms.degrees );
-    outs.write( ' ' );
+      *p++ = '0';
+    p    = put_u16( p, dms.degrees );
+    *p++ = ' ';
 
-    if (dms.minutes < 10)
-      outs.write( '0' );
-    outs.print( dms.minutes );
-    outs.print( F("\' ") );
+    p    = put_2digits( p, dms.minutes );
+    *p++ = '\'';
+    *p++ = ' ';
 
-    if (dms.seconds_whole < 10)
-      outs.write( '0' );
-    outs.print( dms.seconds_whole );
-    outs.write( '.' );
+    p    = put_2digits( p, dms.seconds_whole );
+    *p++ = '.';
 
     if (dms.seconds_frac < 100)
-      outs.write( '0' );
+      *p++ = '0';
     if (dms.seconds_frac < 10)
-      outs.write( '0' );
-    outs.print( dms.seconds_frac );
-    outs.print( F("\" ") );
+      *p++ = '0';
+    p    = put_u16( p, dms.seconds_frac );
+    *p++ = '\"';
+    *p++ = ' ';
+
+    return p;
 
-  } // printDMS
+  } // putDMS
+
+  static char *putLocationDMS( char *p, const gps_fix &fix )
+  {
+    if (fix.valid.location) {
+      p    = putDMS( p, fix.latitudeDMS );
+      *p++ = fix.latitudeDMS.NS();
+      *p++ = ' ';
+      if (fix.longitudeDMS.degrees < 100)
+        *p++ = '0';
+      p    = putDMS( p, fix.longitudeDMS );
+      *p++ = fix.longitudeDMS.EW();
+    }
+    *p++ = ',';
+
+    return p;
+  }
 
 #endif
 //...............
+//  The status and date/time fields are the same for both formats.
 
-Print & operator <<( Print &outs, const gps_fix &fix )
+static char *putStatusTime( char *p, const gps_fix &fix )
 {
   if (fix.valid.status)
-    outs << (uint8_t) fix.status;
-  outs << ',';
+    p = put_u16( p, (uint8_t) fix.status );
+  *p++ = ',';
 
   #if defined(GPS_FIX_DATE) | defined(GPS_FIX_TIME)
     bool someTime = false;
@@ -149,22 +269,136 @@ Print & operator <<( Print &outs, const gps_fix &fix )
     #endif
 
     if (someTime) {
-      outs << fix.dateTime << '.';
-      if (fix.dateTime_cs < 10)
-        outs << '0';
-      outs << fix.dateTime_cs;
+      p   += fix.dateTime.format( p );
+      *p++ = '.';
+      p    = put_2digits( p, fix.dateTime_cs );
     }
-    outs << ',';
+    *p++ = ',';
 
   #else
 
     //  Date/Time not enabled, just output the interval number
     static uint32_t sequence = 0L;
-    outs << sequence++ << ',';
+    p    = put_u32( p, sequence++ );
+    *p++ = ',';
+
+  #endif
+
+  return p;
+}
+
+//...............
+//  Satellite count and receive times are also common to both formats.
+
+static char *putTail( char *p, const gps_fix &fix )
+{
+  #ifdef GPS_FIX_SATELLITES
+    if (fix.valid.satellites)
+      p = put_u16( p, fix.satellites );
+    *p++ = ',';
+  #endif
+
+  #ifdef GPS_FIX_RX_TIME
+    p    = put_u32( p, fix.transfer_us() );
+    *p++ = ',';
+    p    = put_u32( p, fix.rx_parse_us );
+    *p++ = ',';
+    p    = put_u32( p, fix.queued_us() );
+    *p++ = ',';
+  #endif
+
+  return p;
+}
+
+//...............
+
+uint16_t format_fix( char *buf, uint16_t size, const gps_fix &fix )
+{
+  if (size < GPS_FIX_FORMAT_MAX)
+    return 0;
+
+  char *p = putStatusTime( buf, fix );
+
+  #ifdef GPS_FIX_LOCATION
+    if (fix.valid.location) {
+      p    = put_i32( p, fix.latitudeL() );
+      *p++ = ',';
+      p    = put_i32( p, fix.longitudeL() );
+    } else
+      *p++ = ',';
+    *p++ = ',';
+  #endif
+  #ifdef GPS_FIX_LOCATION_DMS
+    p = putLocationDMS( p, fix );
+  #endif
+  #ifdef GPS_FIX_HEADING
+    if (fix.valid.heading)
+      p = put_u16( p, fix.heading_cd() );
+    *p++ = ',';
+  #endif
+  #ifdef GPS_FIX_SPEED
+    if (fix.valid.speed)
+      p = put_u32( p, fix.speed_mkn() );
+    *p++ = ',';
+  #endif
+  #ifdef GPS_FIX_ALTITUDE
+    if (fix.valid.altitude)
+      p = put_i32( p, fix.altitude_cm() );
+    *p++ = ',';
+  #endif
+
+  #ifdef GPS_FIX_HDOP
+    if (fix.valid.hdop)
+      p = put_u16( p, fix.hdop );
+    *p++ = ',';
+  #endif
+  #ifdef GPS_FIX_VDOP
+    if (fix.valid.vdop)
+      p = put_u16( p, fix.vdop );
+    *p++ = ',';
+  #endif
+  #ifdef GPS_FIX_PDOP
+    if (fix.valid.pdop)
+      p = put_u16( p, fix.pdop );
+    *p++ = ',';
+  #endif
+
+  #ifdef GPS_FIX_LAT_ERR
+    if (fix.valid.lat_err)
+      p = put_u16( p, fix.lat_err_cm );
+    *p++ = ',';
+  #endif
+  #ifdef GPS_FIX_LON_ERR
+    if (fix.valid.lon_err)
+      p = put_u16( p, fix.lon_err_cm );
+    *p++ = ',';
+  #endif
+  #ifdef GPS_FIX_ALT_ERR
+    if (fix.valid.alt_err)
+      p = put_u16( p, fix.alt_err_cm );
+    *p++ = ',';
+  #endif
 
+  #ifdef GPS_FIX_GEOID_HEIGHT
+    if (fix.valid.geoidHeight)
+      p = put_i32( p, fix.geoidHeight_cm() );
+    *p++ = ',';
   #endif
 
+  p = putTail( p, fix );
+
+  return p - buf;
+
+} // format_fix
+
+//...............
+
+Print & operator <<( Print &outs, const gps_fix &fix )
+{
   #ifdef USE_FLOAT
+    char  buf[ GPS_FIX_FORMAT_MAX ];
+    outs.write( (const uint8_t *) buf, putStatusTime( buf, fix ) - buf );
+
     #ifdef GPS_FIX_LOCATION
       if (fix.valid.location) {
         outs.print( fix.latitude(), 6 );
@@ -175,16 +409,7 @@ Print & operator <<( Print &outs, const gps_fix &fix )
       outs << ',';
     #endif
     #ifdef GPS_FIX_LOCATION_DMS
-      if (fix.valid.location) {
-        printDMS( outs, fix.latitudeDMS );
-        outs.print( fix.latitudeDMS.NS() );
-        outs.write( ' ' );
-        if (fix.longitudeDMS.degrees < 100)
-          outs.write( '0' );
-        printDMS( outs, fix.longitudeDMS );
-        outs.print( fix.longitudeDMS.EW() );
-      }
-      outs << ',';
+      outs.write( (const uint8_t *) buf, putLocationDMS( buf, fix ) - buf );
     #endif
     #ifdef GPS_FIX_HEADING
       if (fix.valid.heading)
@@ -240,89 +465,15 @@ Print & operator <<( Print &outs, const gps_fix &fix )
       outs << ',';
     #endif
 
-  #else
-
-    // not USE_FLOAT ----------------------
-
-    #ifdef GPS_FIX_LOCATION
-      if (fix.valid.location)
-        outs << fix.latitudeL() << ',' << fix.longitudeL();
-      else
-        outs << ',';
-      outs << ',';
-    #endif
-    #ifdef GPS_FIX_LOCATION_DMS
-      if (fix.valid.location) {
-        printDMS( outs, fix.latitudeDMS );
-        outs.print( fix.latitudeDMS.NS() );
-        outs.write( ' ' );
-        if (fix.longitudeDMS.degrees < 100)
-          outs.write( '0' );
-        printDMS( outs, fix.longitudeDMS );
-        outs.print( fix.longitudeDMS.EW() );
-      }
-      outs << ',';
-    #endif
-    #ifdef GPS_FIX_HEADING
-      if (fix.valid.heading)
-        outs << fix.heading_cd();
-      outs << ',';
-    #endif
-    #ifdef GPS_FIX_SPEED
-      if (fix.valid.speed)
-        outs << fix.speed_mkn();
-      outs << ',';
-    #endif
-    #ifdef GPS_FIX_ALTITUDE
-      if (fix.valid.altitude)
-        outs << fix.altitude_cm();
-      outs << ',';
-    #endif
+    outs.write( (const uint8_t *) buf, putTail( buf, fix ) - buf );
 
-    #ifdef GPS_FIX_HDOP
-      if (fix.valid.hdop)
-        outs << fix.hdop;
-      outs << ',';
-    #endif
-    #ifdef GPS_FIX_VDOP
-      if (fix.valid.vdop)
-        outs << fix.vdop;
-      outs << ',';
-    #endif
-    #ifdef GPS_FIX_PDOP
-      if (fix.valid.pdop)
-        outs << fix.pdop;
-      outs << ',';
-    #endif
+  #else
 
-    #ifdef GPS_FIX_LAT_ERR
-      if (fix.valid.lat_err)
-        outs << fix.lat_err_cm;
-      outs << ',';
-    #endif
-    #ifdef GPS_FIX_LON_ERR
-      if (fix.valid.lon_err)
-        outs << fix.lon_err_cm;
-      outs << ',';
-    #endif
-    #ifdef GPS_FIX_ALT_ERR
-      if (fix.valid.alt_err)
-        outs << fix.alt_err_cm;
-      outs << ',';
-    #endif
+    // not USE_FLOAT: the whole line is formatted at once
 
-    #ifdef GPS_FIX_GEOID_HEIGHT
-      if (fix.valid.geoidHeight)
-        outs << fix.geoidHeight_cm();
-      outs << ',';
-    #endif
-    
-  #endif
+    char buf[ GPS_FIX_FORMAT_MAX ];
+    outs.write( (const uint8_t *) buf, format_fix( buf, sizeof(buf), fix ) );
 
-  #ifdef GPS_FIX_SATELLITES
-    if (fix.valid.satellites)
-      outs << fix.satellites;
-    outs << ',';
   #endif
 
   return outs;
@@ -355,38 +506,124 @@ void trace_header( Print & outs )
 
 //--------------------------
 
+#if defined(NMEAGPS_PARSE_SATELLITES)
+
+  static char *putSatellite( char *p, const NMEAGPS &gps, uint8_t i )
+  {
+    p = put_u16( p, gps.satellites[i].id );
+
+    #if defined(NMEAGPS_PARSE_SATELLITE_INFO)
+      *p++ = ' ';
+      p    = put_u16( p, gps.satellites[i].elevation );
+      *p++ = '/';
+      p    = put_u16( p, gps.satellites[i].azimuth );
+      *p++ = '@';
+      if (gps.satellites[i].tracked)
+        p = put_u16( p, gps.satellites[i].snr );
+      else
+        *p++ = '-';
+    #endif
+
+    *p++ = ',';
+
+    return p;
+  }
+
+  static const uint8_t SAT_FORMAT_MAX =
+    #if defined(NMEAGPS_PARSE_SATELLITE_INFO)
+      18;
+    #else
+      4;
+    #endif
+
+#endif
+
+static const uint8_t TRACE_END_MAX =
+  #if defined(NMEAGPS_PARSE_SATELLITES)
+    2 +
+  #endif
+  #ifdef NMEAGPS_STATS
+    3*11 +
+  #endif
+    1;
+
+static char *putTraceEnd( char *p, const NMEAGPS &gps )
+{
+  #if defined(NMEAGPS_PARSE_SATELLITES)
+    *p++ = ']';
+    *p++ = ',';
+  #endif
+
+  #ifdef NMEAGPS_STATS
+    p    = put_u32( p, gps.statistics.ok );
+    *p++ = ',';
+    p    = put_u32( p, gps.statistics.crc_errors );
+    *p++ = ',';
+    p    = put_u32( p, gps.statistics.chars );
+    *p++ = ',';
+  #endif
+
+  *p++ = '\n';
+
+  return p;
+}
+
+//--------------------------
+
+uint16_t format_all
+  ( char *buf, uint16_t size, const NMEAGPS &gps, const gps_fix &fix )
+{
+  uint16_t needed = TRACE_FORMAT_MAX;
+  #if defined(NMEAGPS_PARSE_SATELLITES)
+    needed -= (NMEAGPS_MAX_SATELLITES - gps.sat_count) * SAT_FORMAT_MAX;
+  #endif
+  if (size < needed)
+    return 0;
+
+  char *p = buf + format_fix( buf, size, fix );
+
+  #if defined(NMEAGPS_PARSE_SATELLITES)
+    *p++ = '[';
+    for (uint8_t i=0; i < gps.sat_count; i++)
+      p = putSatellite( p, gps, i );
+  #endif
+
+  p = putTraceEnd( p, gps );
+
+  return p - buf;
+
+} // format_all
+
+//--------------------------
+//  The satellites are formatted one at a time, so that a line with
+//  many satellites does not need a large buffer on the stack.
+
 void trace_all( Print & outs, const NMEAGPS &gps, const gps_fix &fix )
 {
   outs << fix;
 
+  char buf[ 48 ];
+
   #if defined(NMEAGPS_PARSE_SATELLITES)
-    outs << '[';
+    buf[0] = '[';
+    char *p = &buf[1];
 
     for (uint8_t i=0; i < gps.sat_count; i++) {
-      outs << gps.satellites[i].id;
-
-      #if defined(NMEAGPS_PARSE_SATELLITE_INFO)
-        outs << ' ' << 
-          gps.satellites[i].elevation << '/' << gps.satellites[i].azimuth;
-        outs << '@';
-        if (gps.satellites[i].tracked)
-          outs << gps.satellites[i].snr;
-        else
-          outs << '-';
-      #endif
-
-      outs << ',';
+      if (p + SAT_FORMAT_MAX > &buf[ sizeof(buf) ]) {
+        outs.write( (const uint8_t *) buf, p - buf );
+        p = buf;
+      }
+      p = putSatellite( p, gps, i );
     }
-
-    outs << F("],");
-  #endif
-
-  #ifdef NMEAGPS_STATS
-    outs << gps.statistics.ok         << ','
-          << gps.statistics.crc_errors << ','
-          << gps.statistics.chars      << ',';
+    if (p + TRACE_END_MAX > &buf[ sizeof(buf) ]) {
+      outs.write( (const uint8_t *) buf, p - buf );
+      p = buf;
+    }
+  #else
+    char *p = buf;
   #endif
 
-  outs << '\n';
+  p = putTraceEnd( p, gps );
+  outs.write( (const uint8_t *) buf, p - buf );
 
 } // trace_all
@@ -4,6 +4,8 @@
 #include <Arduino.h>
 
 #include "Time.h"
+#include "GPSfix_cfg.h"
+#include "NMEAGPS_cfg.h"
 
 extern Print & operator <<( Print & outs, const bool b );
 extern Print & operator <<( Print & outs, const char c );
@@ -13,6 +15,22 @@ extern Print & operator <<( Print & outs, const int32_t v );
 extern Print & operator <<( Print & outs, const uint8_t v );
 extern Print & operator <<( Print & outs, const __FlashStringHelper *s );
 
+/**
+ * Integer-to-decimal conversions for the buffer formatters below.  Each
+ * writes the digits at /p/ and returns a pointer just past the last one.
+ * The buffer is not NUL-terminated.  See also put_2digits in Time.h.
+ */
+extern char *put_u16    ( char *p, uint16_t v );
+extern char *put_u32    ( char *p, uint32_t v );
+extern char *put_i32    ( char *p, int32_t  v );
+extern char *put_padded ( char *p, uint32_t v, uint8_t width ); // leading zeroes
+/**
+ * Fixed-point value with a decimal point inserted before the last
+ * /decimals/ digits (0..8).  For example, put_fixed( p, -1234, 3 )
+ * writes "-1.234".  With 0 decimals, no decimal point is written.
+ */
+extern char *put_fixed  ( char *p, int32_t  v, uint8_t decimals );
+
 class gps_fix;
 
 /**
@@ -27,9 +45,110 @@ class gps_fix;
  */
 extern Print & operator <<( Print &outs, const gps_fix &fix );
 
+/**
+ * The largest number of characters that format_fix can write for the
+ * compile-time configuration.  Each field is sized for its largest
+ * value, plus its comma.
+ */
+const uint16_t GPS_FIX_FORMAT_MAX =
+  4                      // status
+  #if defined(GPS_FIX_DATE) | defined(GPS_FIX_TIME)
+    + NeoGPS::time_t::FORMAT_LENGTH + 4 // ".cs,"
+  #else
+    + 11                 // sequence number
+  #endif
+  #ifdef GPS_FIX_LOCATION
+    + 24
+  #endif
+  #ifdef GPS_FIX_LOCATION_DMS
+    + 40
+  #endif
+  #ifdef GPS_FIX_HEADING
+    + 6
+  #endif
+  #ifdef GPS_FIX_SPEED
+    + 11
+  #endif
+  #ifdef GPS_FIX_ALTITUDE
+    + 12
+  #endif
+  #ifdef GPS_FIX_HDOP
+    + 6
+  #endif
+  #ifdef GPS_FIX_VDOP
+    + 6
+  #endif
+  #ifdef GPS_FIX_PDOP
+    + 6
+  #endif
+  #ifdef GPS_FIX_LAT_ERR
+    + 6
+  #endif
+  #ifdef GPS_FIX_LON_ERR
+    + 6
+  #endif
+  #ifdef GPS_FIX_ALT_ERR
+    + 6
+  #endif
+  #ifdef GPS_FIX_GEOID_HEIGHT
+    + 12
+  #endif
+  #ifdef GPS_FIX_SATELLITES
+    + 4
+  #endif
+  #ifdef GPS_FIX_RX_TIME
+    + 3*11
+  #endif
+  ;
+
+/**
+ * Format valid fix data into a character buffer, with the same format
+ * as the stream operator above.  All values are integers; the digits are
+ * generated two at a time, without the Print class or any floating-point
+ * code.  The buffer is not NUL-terminated.
+ * @param[out] buf character buffer.
+ * @param[in] size of /buf/, which must be at least GPS_FIX_FORMAT_MAX.
+ * @param[in] fix gps_fix instance.
+ * @return number of characters written, or 0 if /buf/ is too small.
+ */
+extern uint16_t format_fix( char *buf, uint16_t size, const gps_fix &fix );
+
 class NMEAGPS;
 
+/**
+ * The largest number of characters that format_all can write.  This is
+ * large when satellite information is parsed, so smaller buffers may be
+ * used when fewer satellites are expected.
+ */
+const uint16_t TRACE_FORMAT_MAX =
+  GPS_FIX_FORMAT_MAX
+  #if defined(NMEAGPS_PARSE_SATELLITES)
+    + 3                  // "[],"
+    #if defined(NMEAGPS_PARSE_SATELLITE_INFO)
+      + NMEAGPS_MAX_SATELLITES * 18 // "id elev/az@snr,"
+    #else
+      + NMEAGPS_MAX_SATELLITES * 4  // "id,"
+    #endif
+  #endif
+  #ifdef NMEAGPS_STATS
+    + 3*11
+  #endif
+  + 1                    // newline
+  ;
+
 extern void trace_header( Print & outs );
 extern void trace_all( Print & outs, const NMEAGPS &gps, const gps_fix &fix );
 
+/**
+ * Format one line of trace_all output into a character buffer.
+ * @param[out] buf character buffer.
+ * @param[in] size of /buf/.  TRACE_FORMAT_MAX is always enough.
+ * @param[in] gps NMEAGPS instance, for the satellites and statistics.
+ * @param[in] fix gps_fix instance.
+ * @return number of characters written, or 0 if /buf/ is too small
+ *   for the current number of satellites.
+ */
+extern uint16_t format_all
+  ( char *buf, uint16_t size, const NMEAGPS &gps, const gps_fix &fix );
+
 #endif
\ No newline at end of file
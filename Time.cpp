@@ -28,26 +28,35 @@
 
 Print & operator<<( Print& outs, const NeoGPS::time_t& t )
 {
-  outs.print( t.full_year( t.year ) );
-  outs.write( '-' );
-  if (t.month < 10) outs.write( '0' );
-  outs.print( t.month );
-  outs.write( '-' );
-  if (t.date < 10) outs.write( '0' );
-  outs.print( t.date );
-  outs.write( ' ' );
-  if (t.hours < 10) outs.write( '0' );
-  outs.print( t.hours );
-  outs.write( ':' );
-  if (t.minutes < 10) outs.write( '0' );
-  outs.print( t.minutes );
-  outs.write( ':' );
-  if (t.seconds < 10) outs.write( '0' );
-  outs.print( t.seconds );
+  char buf[ NeoGPS::time_t::FORMAT_LENGTH ];
+  outs.write( (const uint8_t *) buf, t.format( buf ) );
 
   return outs;
 }
 
+//  Digits are generated in pairs from a table, which avoids a division.
+
+static const char digit_pairs[] __PROGMEM =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+char *put_2digits( char *p, uint8_t v )
+{
+  if (v > 99)
+    v = 99;
+  *p++ = pgm_read_byte( &digit_pairs[ 2*v   ] );
+  *p++ = pgm_read_byte( &digit_pairs[ 2*v+1 ] );
+  return p;
+}
+
 using NeoGPS::time_t;
 
 bool time_t::parse(str_P s)
@@ -85,6 +94,28 @@ bool time_t::parse(str_P s)
   return (is_valid());
 }
 
+uint8_t time_t::format( char *buf ) const
+{
+  uint16_t y       = full_year( year );
+  uint8_t  century = y / 100;
+
+  char *p = buf;
+  p    = put_2digits( p, century );
+  p    = put_2digits( p, y - century*100 );
+  *p++ = '-';
+  p    = put_2digits( p, month );
+  *p++ = '-';
+  p    = put_2digits( p, date );
+  *p++ = ' ';
+  p    = put_2digits( p, hours );
+  *p++ = ':';
+  p    = put_2digits( p, minutes );
+  *p++ = ':';
+  p    = put_2digits( p, seconds );
+
+  return FORMAT_LENGTH;
+}
+
 #ifdef TIME_EPOCH_MODIFIABLE
   uint16_t time_t::s_epoch_year    = Y2K_EPOCH_YEAR;
   uint8_t  time_t::s_epoch_offset  = 0;
@@ -96,35 +127,50 @@ const uint8_t time_t::days_in[] __PROGMEM = {
   0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
 };
 
+const uint16_t time_t::days_before[] __PROGMEM = {
+  0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365
+};
+
 time_t::time_t(clock_t c)
 {
   uint16_t dayno = c / SECONDS_PER_DAY;
   c -= dayno * (uint32_t) SECONDS_PER_DAY;
   day = weekday_for(dayno);
 
-  uint16_t y = epoch_year();
-  for (;;) {
-    uint16_t days = days_per( y );
-    if (dayno < days) break;
-    dayno -= days;
+  //  Estimate the year with an average Julian year (365.25 days).
+  //  Gregorian century years and the epoch's position in the leap
+  //  cycle make this off by at most one year, so a single correction
+  //  replaces the old year-by-year loop.
+  uint16_t y          = epoch_year() + (uint16_t) ((dayno * 4UL) / 1461);
+  uint16_t year_start = days_to( y );
+  if (dayno < year_start) {
+    y--;
+    year_start = days_to( y );
+  } else if (dayno >= year_start + days_per( y )) {
+    year_start += days_per( y );
     y++;
   }
+  dayno -= year_start;
+
   bool leap_year = is_leap(y);
   y -= epoch_year();
   y += epoch_offset();
-  while (y > 100)
+  if (y >= 100)
     y -= 100;
   year = y;
 
-  month = 1;
-  for (;;) {
-    uint8_t days = pgm_read_byte(&days_in[month]);
-    if (leap_year && (month == 2)) days++;
-    if (dayno < days) break;
-    dayno -= days;
-    month++;
-  }
-  date = dayno + 1;
+  //  Same idea for the month: dayno/32 is never more than one month
+  //  short of the correct month.
+  uint8_t  m = (dayno >> 5) + 1;
+  uint16_t next_month = pgm_read_word(&days_before[m+1]);
+  if (leap_year && (m >= 2)) next_month++;
+  if (dayno >= next_month)
+    m++;
+  month = m;
+
+  uint16_t month_start = pgm_read_word(&days_before[m]);
+  if (leap_year && (m > 2)) month_start++;
+  date = dayno - month_start + 1;
 
   hours = c / SECONDS_PER_HOUR;
 
@@ -163,24 +209,14 @@ time_t::operator clock_t() const
 
 uint16_t time_t::days() const
 {
-  uint16_t day_count = day_of_year();
-
-  uint16_t y = full_year();
-  while (y-- > epoch_year())
-    day_count += days_per(y);
-
-  return (day_count);
+  return days_to( full_year() ) + day_of_year();
 }
 
 uint16_t time_t::day_of_year() const
 {
-  uint16_t dayno = date - 1;
-  bool leap_year = is_leap();
-
-  for (uint8_t m = 1; m < month; m++) {
-    dayno += pgm_read_byte(&days_in[m]);
-    if (leap_year && (m == 2)) dayno++;
-  }
+  uint16_t dayno = pgm_read_word(&days_before[month]) + date - 1;
+  if ((month > 2) && is_leap())
+    dayno++;
 
   return (dayno);
 }
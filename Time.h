@@ -192,6 +192,29 @@ struct time_t {
     return (365 + is_leap(year));
   }
 
+  /**
+   * Count the leap years from 1 A.D. through the year before /year/.
+   * @param[in] year (4-digit).
+   * @return number of leap years before /year/.
+   */
+  static uint16_t leaps_before(uint16_t year)
+  {
+    year--;
+    return (year/4) - (year/100) + (year/400);
+  }
+
+  /**
+   * Calculate the days from January 1 of the epoch year to
+   * January 1 of the specified year, without iterating.
+   * @param[in] year (4-digit), in the range epoch_year..epoch_year+99.
+   * @return number of days.
+   */
+  static uint16_t days_to(uint16_t year)
+  {
+    return (year - epoch_year()) * (uint16_t) 365 +
+           leaps_before(year) - leaps_before(epoch_year());
+  }
+
   /**
    * Determine the day of the week for the specified day number
    * @param[in] day number as counted from January 1 of the epoch year.
@@ -276,7 +299,18 @@ struct time_t {
    */
   bool parse(str_P s);
 
+  /**
+   * Format the members into a character buffer with the format
+   * "YYYY-MM-DD HH:MM:SS".  The buffer is not NUL-terminated.
+   * @param[out] buf must hold at least FORMAT_LENGTH characters.
+   * @return number of characters written (always FORMAT_LENGTH).
+   */
+  uint8_t format( char *buf ) const;
+
+  static const uint8_t FORMAT_LENGTH = 19;
+
   static const uint8_t days_in[] PROGMEM; // month index is 1..12, PROGMEM
+  static const uint16_t days_before[] PROGMEM; // same, but cumulative (non-leap)
 
 protected:
   static uint8_t  epoch_offset() { return s_epoch_offset; };
@@ -297,6 +331,127 @@ protected:
 
 } NEOGPS_PACKED;
 
+/**
+ * Number of microseconds elapsed since January 1 of the Epoch Year,
+ * 00:00:00 +0000 (UTC).  Unlike a clock_t, the fraction of a second
+ * is kept in the same value, so timestamps from different fixes or
+ * devices can be compared, sorted and subtracted without any
+ * calendar calculations.
+ */
+class timestamp_t
+{
+public:
+
+  static const uint16_t MS_PER_SECOND = 1000;
+  static const uint16_t US_PER_MS     = 1000;
+  static const uint32_t US_PER_SECOND = (uint32_t) US_PER_MS * MS_PER_SECOND;
+
+  /**
+   * Constructor.  Initializes to the start of the epoch.
+   */
+  timestamp_t() : us(0) {}
+
+  /**
+   * Construct from seconds since the Epoch plus a fraction.
+   * @param[in] c clock.
+   * @param[in] fraction_us microseconds since /c/.
+   */
+  explicit timestamp_t( clock_t c, uint32_t fraction_us = 0 )
+    : us( c * (uint64_t) US_PER_SECOND + fraction_us ) {}
+
+  /**
+   * Construct from a date/time plus a fraction.
+   * @param[in] t date and time.
+   * @param[in] fraction_us microseconds since /t/.
+   */
+  timestamp_t( const time_t & t, uint32_t fraction_us = 0 )
+    : us( (clock_t) t * (uint64_t) US_PER_SECOND + fraction_us ) {}
+
+  /**
+   * Construct from a raw count of microseconds or milliseconds.
+   */
+  static timestamp_t from_us( uint64_t us )
+    { timestamp_t ts; ts.us = us; return ts; }
+  static timestamp_t from_ms( uint64_t ms )
+    { return from_us( ms * US_PER_MS ); }
+
+  /**
+   * Construct from a POSIX time, which counts from January 1, 1970.
+   * @param[in] posix_s seconds since the POSIX epoch.
+   * @param[in] fraction_us microseconds since /posix_s/.
+   */
+  static timestamp_t from_posix( int64_t posix_s, uint32_t fraction_us = 0 )
+    { return from_us( (posix_s - posix_offset()) * US_PER_SECOND + fraction_us ); }
+
+  /**
+   * Accessors.
+   */
+  uint64_t microseconds() const { return us; }
+  uint64_t milliseconds() const { return us / US_PER_MS; }
+
+  /**
+   * @return whole seconds since the Epoch.
+   */
+  clock_t  seconds() const { return us / US_PER_SECOND; }
+
+  /**
+   * @return microseconds since the last whole second.
+   */
+  uint32_t fraction_us() const { return us - seconds() * (uint64_t) US_PER_SECOND; }
+
+  /**
+   * @return whole seconds since January 1, 1970.
+   */
+  int64_t  posix() const { return (int64_t) seconds() + posix_offset(); }
+
+  /**
+   * Convert to a date/time.  The fraction is discarded.
+   */
+  operator time_t() const { return time_t( seconds() ); }
+
+  /**
+   * Seconds from the POSIX epoch to the NeoGPS Epoch.  This is negative
+   * when the Epoch Year is before 1970 (e.g., the NTP epoch).
+   */
+  static int64_t posix_offset()
+  {
+    const uint16_t POSIX_YEAR = time_t::POSIX_EPOCH_YEAR;
+    int32_t days = (int32_t) ((int16_t) (time_t::epoch_year() - POSIX_YEAR)) * 365 +
+                   (int16_t) (time_t::leaps_before( time_t::epoch_year() ) -
+                              time_t::leaps_before( POSIX_YEAR ));
+    return days * (int64_t) SECONDS_PER_DAY;
+  }
+
+  /**
+   * Comparisons are a single 64-bit compare.
+   */
+  bool operator ==( const timestamp_t & r ) const { return us == r.us; }
+  bool operator !=( const timestamp_t & r ) const { return us != r.us; }
+  bool operator < ( const timestamp_t & r ) const { return us <  r.us; }
+  bool operator <=( const timestamp_t & r ) const { return us <= r.us; }
+  bool operator > ( const timestamp_t & r ) const { return us >  r.us; }
+  bool operator >=( const timestamp_t & r ) const { return us >= r.us; }
+
+  /**
+   * Difference between two timestamps.
+   * @return signed microseconds from /r/ to *this.
+   */
+  int64_t operator -( const timestamp_t & r ) const
+    { return (int64_t) (us - r.us); }
+
+  /**
+   * Offset by a signed number of microseconds.
+   */
+  timestamp_t & operator +=( int64_t offset_us )
+    { us += offset_us; return *this; }
+  timestamp_t & operator -=( int64_t offset_us )
+    { us -= offset_us; return *this; }
+
+protected:
+  uint64_t us;
+
+} NEOGPS_PACKED;
+
 }; // namespace NeoGPS
 
 class Print;
@@ -309,4 +464,12 @@ class Print;
  */
 Print & operator <<( Print & outs, const NeoGPS::time_t &t );
 
+/**
+ * Write two decimal digits with a leading zero (e.g., "07") into a
+ * character buffer.  Values over 99 are written as "99".  This is
+ * also used by the formatters in Streamers.h.
+ * @return pointer just past the second digit.
+ */
+extern char *put_2digits( char *p, uint8_t v );
+
 #endif
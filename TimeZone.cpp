@@ -0,0 +1,137 @@
+/**
+ * @file TimeZone.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "TimeZone.h"
+
+namespace NeoGPS {
+
+//----------------------------------------------------------------
+//  Common zones.  Rules are current as of 2016.
+
+static const uint8_t SUN  = time_t::SUNDAY;
+static const uint8_t LAST = dst_rule_t::LAST_WEEK;
+
+//  { std minutes, dst minutes,
+//    DST start { month, week, weekday, hours, minutes },
+//    DST end   { month, week, weekday, hours, minutes } }
+
+const zone_t ZONE_UTC         __PROGMEM = {    0,  0, {  0,    0,   0, 0, 0 }, {  0,    0,   0, 0, 0 } };
+
+// US: 2nd Sunday in March at 2:00, 1st Sunday in November at 2:00
+const zone_t ZONE_US_EASTERN  __PROGMEM = { -300, 60, {  3,    2, SUN, 2, 0 }, { 11,    1, SUN, 2, 0 } };
+const zone_t ZONE_US_CENTRAL  __PROGMEM = { -360, 60, {  3,    2, SUN, 2, 0 }, { 11,    1, SUN, 2, 0 } };
+const zone_t ZONE_US_MOUNTAIN __PROGMEM = { -420, 60, {  3,    2, SUN, 2, 0 }, { 11,    1, SUN, 2, 0 } };
+const zone_t ZONE_US_ARIZONA  __PROGMEM = { -420,  0, {  0,    0,   0, 0, 0 }, {  0,    0,   0, 0, 0 } };
+const zone_t ZONE_US_PACIFIC  __PROGMEM = { -480, 60, {  3,    2, SUN, 2, 0 }, { 11,    1, SUN, 2, 0 } };
+const zone_t ZONE_US_ALASKA   __PROGMEM = { -540, 60, {  3,    2, SUN, 2, 0 }, { 11,    1, SUN, 2, 0 } };
+const zone_t ZONE_US_HAWAII   __PROGMEM = { -600,  0, {  0,    0,   0, 0, 0 }, {  0,    0,   0, 0, 0 } };
+
+// EU: last Sunday in March at 01:00 UTC, last Sunday in October at 01:00 UTC
+const zone_t ZONE_EU_WESTERN  __PROGMEM = {    0, 60, {  3, LAST, SUN, 1, 0 }, { 10, LAST, SUN, 2, 0 } };
+const zone_t ZONE_EU_CENTRAL  __PROGMEM = {   60, 60, {  3, LAST, SUN, 2, 0 }, { 10, LAST, SUN, 3, 0 } };
+const zone_t ZONE_EU_EASTERN  __PROGMEM = {  120, 60, {  3, LAST, SUN, 3, 0 }, { 10, LAST, SUN, 4, 0 } };
+
+const zone_t ZONE_JAPAN       __PROGMEM = {  540,  0, {  0,    0,   0, 0, 0 }, {  0,    0,   0, 0, 0 } };
+
+// Southern hemisphere: DST starts late in the year and ends early in the next
+const zone_t ZONE_AU_EASTERN  __PROGMEM = {  600, 60, { 10,    1, SUN, 2, 0 }, {  4,    1, SUN, 3, 0 } };
+const zone_t ZONE_NEW_ZEALAND __PROGMEM = {  720, 60, {  9, LAST, SUN, 2, 0 }, {  4,    1, SUN, 3, 0 } };
+
+//----------------------------------------------------------------
+
+clock_t TimeZone::transition
+  ( const dst_rule_t *rule_P, uint16_t year, int32_t offset )
+{
+  dst_rule_t rule;
+  memcpy_P( &rule, rule_P, sizeof(rule) );
+
+  bool     leap_year = time_t::is_leap( year );
+  uint16_t first     = time_t::days_to( year ) +
+                       pgm_read_word( &time_t::days_before[ rule.month ] );
+  if (leap_year && (rule.month > 2))
+    first++;
+
+  uint16_t dayno;
+  if (rule.week == dst_rule_t::LAST_WEEK) {
+    dayno = first + pgm_read_byte( &time_t::days_in[ rule.month ] ) - 1;
+    if (leap_year && (rule.month == 2))
+      dayno++;
+    dayno -= (time_t::weekday_for( dayno ) - rule.weekday + DAYS_PER_WEEK) % DAYS_PER_WEEK;
+  } else {
+    dayno  = first + (rule.weekday - time_t::weekday_for( first ) + DAYS_PER_WEEK) % DAYS_PER_WEEK;
+    dayno += (rule.week - 1) * DAYS_PER_WEEK;
+  }
+
+  return dayno * SECONDS_PER_DAY +
+         rule.hours   * (uint16_t) SECONDS_PER_HOUR +
+         rule.minutes * (uint16_t) SECONDS_PER_MINUTE -
+         offset;
+
+} // transition
+
+//----------------------------------------------------------------
+//  Find the UTC span around /utc/ where the offset does not change.
+//  Each span is also limited to one UTC year, so only the two
+//  transitions of that year are needed.
+
+void TimeZone::update( clock_t utc )
+{
+  int16_t std_minutes = pgm_read_word( &m_zone->std_minutes );
+  uint8_t dst_minutes = pgm_read_byte( &m_zone->dst_minutes );
+  int32_t std_offset  = std_minutes * (int32_t) SECONDS_PER_MINUTE;
+
+  uint16_t year       = time_t( utc ).full_year();
+  clock_t  year_start = time_t::days_to( year ) * SECONDS_PER_DAY;
+  clock_t  year_end   = year_start + time_t::days_per( year ) * SECONDS_PER_DAY;
+
+  clock_t  start = year_start;
+  clock_t  end   = year_end;
+  bool     dst   = false;
+
+  if (dst_minutes) {
+    int32_t dst_offset = std_offset + dst_minutes * (int32_t) SECONDS_PER_MINUTE;
+    clock_t on         = transition( &m_zone->dst_start, year, std_offset );
+    clock_t off        = transition( &m_zone->dst_end  , year, dst_offset );
+
+    bool    northern   = (on < off);
+    clock_t first      = northern ? on  : off;
+    clock_t second     = northern ? off : on;
+
+    if (utc < first) {
+      end   = first;
+      dst   = !northern;
+    } else if (utc < second) {
+      start = first;
+      end   = second;
+      dst   = northern;
+    } else {
+      start = second;
+      dst   = !northern;
+    }
+  }
+
+  m_start  = start;
+  m_length = end - start;
+  m_dst    = dst;
+  m_offset = std_offset;
+  if (dst)
+    m_offset += dst_minutes * (int32_t) SECONDS_PER_MINUTE;
+
+} // update
+
+}; // namespace NeoGPS
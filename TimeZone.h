@@ -0,0 +1,157 @@
+#ifndef TIMEZONE_H
+#define TIMEZONE_H
+
+/**
+ * @file TimeZone.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "Time.h"
+
+namespace NeoGPS {
+
+/**
+ * A daylight saving time transition rule, like "the last Sunday
+ * of March at 02:00".  The hour and minute are local time, using
+ * the offset that is in effect just *before* the transition (i.e.,
+ * standard time for the start of DST, daylight time for the end).
+ */
+struct dst_rule_t {
+  uint8_t month;   //!< 1-12 Month
+  uint8_t week;    //!< 1-4 for the Nth weekday, or LAST_WEEK
+  uint8_t weekday; //!< 1-7 Day, as in time_t::day (SUNDAY is 1)
+  uint8_t hours;   //!< 00-23 Hours
+  uint8_t minutes; //!< 00-59 Minutes
+
+  static const uint8_t LAST_WEEK = 5;
+} NEOGPS_PACKED;
+
+/**
+ * A compiled timezone rule.  Zones without daylight saving time
+ * have a dst_minutes of 0, and the two rules are ignored.  These
+ * are usually stored in PROGMEM; several common zones are provided
+ * below.
+ */
+struct zone_t {
+  int16_t    std_minutes; //!< standard offset from UTC, in minutes
+  uint8_t    dst_minutes; //!< additional offset during DST, usually 60
+  dst_rule_t dst_start;
+  dst_rule_t dst_end;
+} NEOGPS_PACKED;
+
+extern const zone_t ZONE_UTC           PROGMEM;
+extern const zone_t ZONE_US_EASTERN    PROGMEM;
+extern const zone_t ZONE_US_CENTRAL    PROGMEM;
+extern const zone_t ZONE_US_MOUNTAIN   PROGMEM;
+extern const zone_t ZONE_US_ARIZONA    PROGMEM;
+extern const zone_t ZONE_US_PACIFIC    PROGMEM;
+extern const zone_t ZONE_US_ALASKA     PROGMEM;
+extern const zone_t ZONE_US_HAWAII     PROGMEM;
+extern const zone_t ZONE_EU_WESTERN    PROGMEM;
+extern const zone_t ZONE_EU_CENTRAL    PROGMEM;
+extern const zone_t ZONE_EU_EASTERN    PROGMEM;
+extern const zone_t ZONE_JAPAN         PROGMEM;
+extern const zone_t ZONE_AU_EASTERN    PROGMEM;
+extern const zone_t ZONE_NEW_ZEALAND   PROGMEM;
+
+/**
+ * Convert UTC times to local times for one zone.
+ *
+ * The UTC span between two transitions is cached, along with the offset
+ * that applies during that span.  As long as the UTC times stay inside
+ * that span, a conversion is one comparison and one add.  The calendar
+ * calculations are only performed when a transition is crossed, or for
+ * the first conversion of a new year.
+ */
+class TimeZone
+{
+public:
+
+  /**
+   * Constructor.
+   * @param[in] zone_P PROGMEM zone rule (e.g., &ZONE_US_EASTERN).
+   */
+  explicit TimeZone( const zone_t *zone_P )
+    : m_zone( zone_P ), m_start( 0 ), m_length( 0 ), m_offset( 0 ), m_dst( false )
+    {}
+
+  /**
+   * Select a different zone rule.
+   * @param[in] zone_P PROGMEM zone rule.
+   */
+  void zone( const zone_t *zone_P )
+  {
+    m_zone   = zone_P;
+    m_length = 0; // invalidate the cache
+  }
+
+  /**
+   * Calculate the local offset in effect at a UTC time.
+   * @param[in] utc seconds since the epoch.
+   * @return seconds to add to /utc/ for the local time.
+   */
+  int32_t offset( clock_t utc )
+  {
+    if ((clock_t)(utc - m_start) >= m_length)
+      update( utc );
+    return m_offset;
+  }
+
+  /**
+   * Convert a UTC time to local time.
+   * @param[in] utc seconds since the epoch.
+   * @return local seconds since the epoch.
+   */
+  clock_t local( clock_t utc )
+    { return utc + offset( utc ); }
+
+  /**
+   * Convert a UTC date/time to a local date/time.
+   * @param[in] utc date/time.
+   * @return local date/time.
+   */
+  time_t local( const time_t & utc )
+    { return time_t( local( (clock_t) utc ) ); }
+
+  /**
+   * @return true if the last conversion was during daylight saving time.
+   */
+  bool dst() const { return m_dst; }
+
+  /**
+   * Calculate when a DST rule takes effect in the given year.
+   * @param[in] rule_P PROGMEM transition rule.
+   * @param[in] year (4-digit).
+   * @param[in] offset seconds of local offset in effect before the transition.
+   * @return UTC seconds since the epoch.
+   */
+  static clock_t transition( const dst_rule_t *rule_P, uint16_t year, int32_t offset );
+
+protected:
+  const zone_t *m_zone;
+
+  // Cached UTC span [m_start, m_start+m_length) and its offset.
+  clock_t       m_start;
+  clock_t       m_length;
+  int32_t       m_offset;
+  bool          m_dst;
+
+  void update( clock_t utc );
+};
+
+}; // namespace NeoGPS
+
+#endif
@@ -0,0 +1,262 @@
+/**
+ * @file TrackWriter.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "TrackWriter.h"
+
+#ifdef GPS_FIX_LOCATION
+
+//------------------------------------------------------------------
+
+void TrackWriter::begin( const __FlashStringHelper *name )
+{
+  m_len        = 0;
+  m_in_segment = false;
+  m_points     = 0;
+  m_segments   = 0;
+
+  header( name );
+}
+
+//------------------------------------------------------------------
+
+void TrackWriter::write( const gps_fix &fix )
+{
+  if (fix.valid.status && (fix.status == gps_fix::STATUS_NONE)) {
+    if (m_in_segment) {
+      segment_end();
+      m_in_segment = false;
+    }
+
+  } else if (fix.valid.location) {
+    if (!m_in_segment) {
+      segment_begin();
+      m_in_segment = true;
+      m_segments++;
+    }
+
+    if (m_len > sizeof(m_buf) - TRACK_POINT_MAX)
+      flush();
+    m_len = point( &m_buf[ m_len ], fix ) - m_buf;
+    m_points++;
+  }
+
+} // write
+
+//------------------------------------------------------------------
+
+void TrackWriter::end()
+{
+  if (m_in_segment) {
+    segment_end();
+    m_in_segment = false;
+  }
+  footer();
+  flush();
+}
+
+//------------------------------------------------------------------
+
+void TrackWriter::flush()
+{
+  if (m_len) {
+    m_outs.write( (const uint8_t *) m_buf, m_len );
+    m_len = 0;
+  }
+}
+
+//------------------------------------------------------------------
+
+void TrackWriter::put_P( const char *s_P )
+{
+  for (;;) {
+    char c = pgm_read_byte( s_P++ );
+    if (!c)
+      break;
+    if (m_len == sizeof(m_buf))
+      flush();
+    m_buf[ m_len++ ] = c;
+  }
+}
+
+//------------------------------------------------------------------
+//  Element text must not contain markup characters.
+
+static const char amp[] __PROGMEM = "&amp;";
+static const char lt [] __PROGMEM = "&lt;";
+static const char gt [] __PROGMEM = "&gt;";
+
+void TrackWriter::put_text_P( const char *s_P )
+{
+  for (;;) {
+    char c = pgm_read_byte( s_P++ );
+    if (!c)
+      break;
+    if (c == '&')
+      put_P( amp );
+    else if (c == '<')
+      put_P( lt );
+    else if (c == '>')
+      put_P( gt );
+    else {
+      if (m_len == sizeof(m_buf))
+        flush();
+      m_buf[ m_len++ ] = c;
+    }
+  }
+}
+
+//------------------------------------------------------------------
+//  Common markup
+
+static const char xml_header[] __PROGMEM =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+static const char name_begin[] __PROGMEM = "<name>";
+static const char name_end  [] __PROGMEM = "</name>\n";
+
+#if defined(GPS_FIX_DATE) & defined(GPS_FIX_TIME)
+
+  //  "YYYY-MM-DDTHH:MM:SS.ccZ"
+
+  static char *put_utc( char *p, const gps_fix &fix )
+  {
+    char *dt = p;
+    p     += fix.dateTime.format( p );
+    dt[10] = 'T';
+    *p++   = '.';
+    p      = put_2digits( p, fix.dateTime_cs );
+    *p++   = 'Z';
+
+    return p;
+  }
+
+#endif
+
+//------------------------------------------------------------------
+//  GPX
+
+static const char gpx_header[] __PROGMEM =
+  "<gpx version=\"1.1\" creator=\"NeoGPS\" "
+    "xmlns=\"http://www.topografix.com/GPX/1/1\">\n"
+  "<trk>\n";
+static const char gpx_seg_begin[] __PROGMEM = "<trkseg>\n";
+static const char gpx_seg_end  [] __PROGMEM = "</trkseg>\n";
+static const char gpx_footer   [] __PROGMEM = "</trk>\n</gpx>\n";
+
+void GPXwriter::header( const __FlashStringHelper *name )
+{
+  put_P( xml_header );
+  put_P( gpx_header );
+  if (name) {
+    put_P( name_begin );
+    put_text_P( (const char *) name );
+    put_P( name_end );
+  }
+}
+
+void GPXwriter::segment_begin() { put_P( gpx_seg_begin ); }
+void GPXwriter::segment_end  () { put_P( gpx_seg_end   ); }
+void GPXwriter::footer       () { put_P( gpx_footer    ); }
+
+static const char gpx_lat   [] __PROGMEM = "<trkpt lat=\"";
+static const char gpx_lon   [] __PROGMEM = "\" lon=\"";
+static const char gpx_attrs [] __PROGMEM = "\">";
+static const char gpx_ele   [] __PROGMEM = "<ele>";
+static const char gpx_ele_  [] __PROGMEM = "</ele>";
+static const char gpx_time  [] __PROGMEM = "<time>";
+static const char gpx_time_ [] __PROGMEM = "</time>";
+static const char gpx_trkpt_[] __PROGMEM = "</trkpt>\n";
+
+// Unlike put_P, this writes into the point buffer and only takes the
+// arrays above (sizeof must be the tag length plus its NUL).
+#define PUT_TAG(p,s) (memcpy_P( p, s, sizeof(s)-1 ), p += sizeof(s)-1)
+
+char *GPXwriter::point( char *p, const gps_fix &fix )
+{
+  PUT_TAG( p, gpx_lat );
+  p = put_fixed( p, fix.latitudeL(), 7 );
+  PUT_TAG( p, gpx_lon );
+  p = put_fixed( p, fix.longitudeL(), 7 );
+  PUT_TAG( p, gpx_attrs );
+
+  #ifdef GPS_FIX_ALTITUDE
+    if (fix.valid.altitude) {
+      PUT_TAG( p, gpx_ele );
+      p = put_fixed( p, fix.altitude_cm(), 2 );
+      PUT_TAG( p, gpx_ele_ );
+    }
+  #endif
+
+  #if defined(GPS_FIX_DATE) & defined(GPS_FIX_TIME)
+    if (fix.valid.date && fix.valid.time) {
+      PUT_TAG( p, gpx_time );
+      p = put_utc( p, fix );
+      PUT_TAG( p, gpx_time_ );
+    }
+  #endif
+
+  PUT_TAG( p, gpx_trkpt_ );
+  return p;
+
+} // GPXwriter::point
+
+//------------------------------------------------------------------
+//  KML
+
+static const char kml_header[] __PROGMEM =
+  "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+  "<Document>\n";
+static const char kml_seg_begin[] __PROGMEM =
+  "<Placemark><LineString><coordinates>\n";
+static const char kml_seg_end[] __PROGMEM =
+  "</coordinates></LineString></Placemark>\n";
+static const char kml_footer[] __PROGMEM = "</Document>\n</kml>\n";
+
+void KMLwriter::header( const __FlashStringHelper *name )
+{
+  put_P( xml_header );
+  put_P( kml_header );
+  if (name) {
+    put_P( name_begin );
+    put_text_P( (const char *) name );
+    put_P( name_end );
+  }
+}
+
+void KMLwriter::segment_begin() { put_P( kml_seg_begin ); }
+void KMLwriter::segment_end  () { put_P( kml_seg_end   ); }
+void KMLwriter::footer       () { put_P( kml_footer    ); }
+
+char *KMLwriter::point( char *p, const gps_fix &fix )
+{
+  p    = put_fixed( p, fix.longitudeL(), 7 );
+  *p++ = ',';
+  p    = put_fixed( p, fix.latitudeL(), 7 );
+
+  #ifdef GPS_FIX_ALTITUDE
+    if (fix.valid.altitude) {
+      *p++ = ',';
+      p    = put_fixed( p, fix.altitude_cm(), 2 );
+    }
+  #endif
+
+  *p++ = '\n';
+  return p;
+
+} // KMLwriter::point
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef TRACKWRITER_H
+#define TRACKWRITER_H
+
+/**
+ * @file TrackWriter.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "Streamers.h"
+#include "GPSfix.h"
+
+#ifdef GPS_FIX_LOCATION
+
+//------------------------------------------------------------------
+//  Streaming GPX and KML track writers.
+//
+//  Each fix from gps.read() is written as one track point, as it
+//  arrives.  Nothing is kept except a small output buffer, so tracks
+//  of any length can be written to an SD file or a Serial port.
+//
+//  A new track segment is started after a fix with a valid status of
+//  STATUS_NONE.  Fixes without a valid location are skipped.  Note that
+//  EXPLICIT_MERGING only keeps the most accurate status of an interval,
+//  and without NMEAGPS_COHERENT, a buffered fix retains the members
+//  from earlier intervals.  NMEAGPS_COHERENT is recommended so that a
+//  lost fix reaches the writer.
+//
+//  Characters are collected in a buffer of TRACK_CHUNK_SIZE bytes and
+//  written to the Print stream with one write call when the buffer is
+//  full.  A larger chunk means fewer (and larger) writes, which is
+//  usually faster for SD cards.  It must hold at least one point.
+
+#ifndef TRACK_CHUNK_SIZE
+  #define TRACK_CHUNK_SIZE 128
+#endif
+
+//  Largest GPX point: lat/lon, elevation and time.
+#define TRACK_POINT_MAX 120
+
+#if TRACK_CHUNK_SIZE < TRACK_POINT_MAX
+  #error TRACK_CHUNK_SIZE must be at least TRACK_POINT_MAX!
+#endif
+
+class TrackWriter
+{
+public:
+
+  /**
+   * Write the document header.  This must be called first.
+   * @param[in] name optional F() string for the track name.
+   */
+  void begin( const __FlashStringHelper *name = NULL );
+
+  /**
+   * Add one fix to the track, or end the current segment.
+   * @param[in] fix gps_fix from gps.read().
+   */
+  void write( const gps_fix &fix );
+
+  /**
+   * End the current segment (if any), write the document footer and
+   * flush the buffer.  The document is not valid until this is called.
+   */
+  void end();
+
+  /**
+   * Write any buffered characters to the stream.  This does not
+   * close the document.
+   */
+  void flush();
+
+  uint32_t points  () const { return m_points; }
+  uint16_t segments() const { return m_segments; }
+
+protected:
+  TrackWriter( Print & outs )
+    : m_outs( outs ), m_len( 0 ), m_in_segment( false ),
+      m_points( 0 ), m_segments( 0 )
+    {}
+
+  // These are provided by the specific formats.
+  virtual void  header( const __FlashStringHelper *name ) = 0;
+  virtual void  segment_begin() = 0;
+  virtual void  segment_end  () = 0;
+  virtual void  footer       () = 0;
+  //  Format one point at /p/, returning a pointer just past it.  At
+  //  most TRACK_POINT_MAX characters may be written.
+  virtual char *point( char *p, const gps_fix &fix ) = 0;
+
+  //  Append a PROGMEM string to the buffer, flushing as needed.
+  void put_P( const char *s_P );
+  //  Append a PROGMEM string, replacing '&', '<' and '>' with entities.
+  void put_text_P( const char *s_P );
+
+  Print   & m_outs;
+  char      m_buf[ TRACK_CHUNK_SIZE ];
+  uint16_t  m_len;
+  bool      m_in_segment;
+  uint32_t  m_points;
+  uint16_t  m_segments;
+};
+
+//------------------------------------------------------------------
+/**
+ * GPX 1.1 track.  Each point has its latitude and longitude, plus the
+ * elevation and UTC time when they are valid.
+ */
+class GPXwriter : public TrackWriter
+{
+public:
+  explicit GPXwriter( Print & outs ) : TrackWriter( outs ) {}
+
+protected:
+  void  header( const __FlashStringHelper *name );
+  void  segment_begin();
+  void  segment_end  ();
+  void  footer       ();
+  char *point( char *p, const gps_fix &fix );
+};
+
+//------------------------------------------------------------------
+/**
+ * KML 2.2 document.  Each segment is a Placemark with a LineString of
+ * "lon,lat[,alt]" coordinates.  KML LineStrings do not have times.
+ */
+class KMLwriter : public TrackWriter
+{
+public:
+  explicit KMLwriter( Print & outs ) : TrackWriter( outs ) {}
+
+protected:
+  void  header( const __FlashStringHelper *name );
+  void  segment_begin();
+  void  segment_end  ();
+  void  footer       ();
+  char *point( char *p, const gps_fix &fix );
+};
+
+#endif
+
+#endif
@@ -219,6 +219,8 @@ static void GPSloop()
       // If you like the CSV format implemented in Streamers.h,
       //   you could replace all these prints with 
       // trace_all( logFile, fix ); // uncomment include Streamers.h
+      //
+      // To log a GPX or KML track instead, see GPXwriter in TrackWriter.h.
 
       printL( logfile, fix.latitudeL() );
       logfile.print( ',' );
@@ -9,9 +9,13 @@
 //          timezone they are in, so they always report a UTC time.  This
 //          is the same as GMT.
 //
+//          A NeoGPS::TimeZone applies the daylight saving time rules
+//          for the selected zone.  See TimeZone.h for the other zones,
+//          or declare a zone_t with your own rules.
+//
 //  Prerequisites:
 //     1) NMEA.ino works with your device
-//     2) GPS_FIX_TIME is enabled in GPSfix_cfg.h
+//     2) GPS_FIX_TIME and GPS_FIX_DATE are enabled in GPSfix_cfg.h
 //     3) NMEAGPS_PARSE_RMC is enabled in NMEAGPS_cfg.h.  You could use 
 //        any sentence that contains a time field.  Be sure to change the 
 //        "if" statement in GPSloop from RMC to your selected sentence.
@@ -39,11 +43,16 @@
   #define DEBUG_PORT Serial
 #endif
 
+#include "TimeZone.h"
+
 static NMEAGPS  gps         ; // This parses received characters
 static gps_fix  fix_data;
 
-#if !defined(GPS_FIX_TIME)
-  #error You must define GPS_FIX_TIME in GPSfix_cfg.h!
+// Set this to your timezone
+static NeoGPS::TimeZone zone( &NeoGPS::ZONE_US_EASTERN );
+
+#if !defined(GPS_FIX_TIME) | !defined(GPS_FIX_DATE)
+  #error You must define GPS_FIX_TIME and GPS_FIX_DATE in GPSfix_cfg.h!
 #endif
 
 #if !defined(NMEAGPS_PARSE_RMC)
@@ -56,17 +65,12 @@ static void doSomeWork( const gps_fix & fix )
 {
   // Display the local time
 
-  if (fix.valid.time) {
-    // Set these values to the offset of your timezone from GMT
-    static const int32_t         zone_hours   = -4L; // EST
-    static const int32_t         zone_minutes =  0L; // usually zero
-    static const NeoGPS::clock_t zone_offset  =
-                      zone_hours   * NeoGPS::SECONDS_PER_HOUR +
-                      zone_minutes * NeoGPS::SECONDS_PER_MINUTE;
-
-    NeoGPS::time_t localTime( fix.dateTime + zone_offset );
+  if (fix.valid.date && fix.valid.time) {
+    NeoGPS::time_t localTime = zone.local( fix.dateTime );
 
     DEBUG_PORT << localTime;
+    if (zone.dst())
+      DEBUG_PORT.print( F(" DST") );
   }
   DEBUG_PORT.println();
 
@@ -0,0 +1,165 @@
+#include <Arduino.h>
+#include "Time.h"
+
+//======================================================================
+//  Program: NeoTimeBenchmark.ino
+//
+//  Prerequisites:
+//
+//  Description:  Check and time the NeoGPS::time_t date conversions
+//     for every day from 2000 through 2099.
+//
+//     Each day number is converted to a time_t and back again, and
+//     the results are compared with the original loop-based
+//     implementation, which is included below for reference.
+//     Average times are displayed in microseconds.
+//
+//  'Serial' is for debug output to the Serial Monitor window.
+//
+//======================================================================
+
+#include "Streamers.h"
+
+using NeoGPS::time_t;
+
+static const uint16_t FIRST_YEAR = 2000;
+static const uint16_t LAST_YEAR  = 2099;
+
+//--------------------------
+// The original conversions iterated over every year since the
+// epoch, and over every month of the current year.
+
+static void loop_date( uint16_t dayno, time_t & t )
+{
+  uint16_t y = time_t::epoch_year();
+  for (;;) {
+    uint16_t days = time_t::days_per( y );
+    if (dayno < days) break;
+    dayno -= days;
+    y++;
+  }
+  bool leap_year = time_t::is_leap(y);
+  t.year = y % 100;
+
+  t.month = 1;
+  for (;;) {
+    uint8_t days = pgm_read_byte(&time_t::days_in[t.month]);
+    if (leap_year && (t.month == 2)) days++;
+    if (dayno < days) break;
+    dayno -= days;
+    t.month++;
+  }
+  t.date = dayno + 1;
+}
+
+static uint16_t loop_days( const time_t & t )
+{
+  uint16_t day_count = t.date - 1;
+  bool leap_year = t.is_leap();
+
+  for (uint8_t m = 1; m < t.month; m++) {
+    day_count += pgm_read_byte(&time_t::days_in[m]);
+    if (leap_year && (m == 2)) day_count++;
+  }
+
+  uint16_t y = t.full_year();
+  while (y-- > time_t::epoch_year())
+    day_count += time_t::days_per(y);
+
+  return (day_count);
+}
+
+//--------------------------
+
+static uint16_t day_count;
+
+static void check()
+{
+  uint16_t errors = 0;
+  time_t   expected;
+
+  for (uint16_t dayno = 0; dayno < day_count; dayno++) {
+    time_t t( dayno * (NeoGPS::clock_t) NeoGPS::SECONDS_PER_DAY );
+    loop_date( dayno, expected );
+
+    if ((t.year  != expected.year ) ||
+        (t.month != expected.month) ||
+        (t.date  != expected.date ) ||
+        (t.days() != dayno)) {
+      if (errors < 10)
+        Serial << F("FAILED: day ") << dayno << F(" -> ") << t << '\n';
+      errors++;
+    }
+  }
+
+  Serial << day_count << F(" days checked, ") << errors << F(" errors\n");
+}
+
+//--------------------------
+
+static volatile uint16_t sink; // keeps the optimizer honest
+
+static void time_it()
+{
+  uint32_t start, end;
+  time_t   t;
+
+  Serial.flush();
+  start = micros();
+  for (uint16_t dayno = 0; dayno < day_count; dayno++) {
+    t = time_t( dayno * (NeoGPS::clock_t) NeoGPS::SECONDS_PER_DAY );
+    sink = t.date;
+  }
+  end = micros();
+  Serial << F("clock_t -> time_t: ") << (end-start)/day_count << F("us, ");
+
+  Serial.flush();
+  start = micros();
+  for (uint16_t dayno = 0; dayno < day_count; dayno++) {
+    loop_date( dayno, t );
+    sink = t.date;
+  }
+  end = micros();
+  Serial << (end-start)/day_count << F("us with loops\n");
+
+  t = time_t( (day_count-1) * (NeoGPS::clock_t) NeoGPS::SECONDS_PER_DAY );
+
+  Serial.flush();
+  start = micros();
+  for (uint16_t i = day_count; i > 0; i--)
+    sink = t.days();
+  end = micros();
+  Serial << F("days() at ") << t << F(": ")
+         << (end-start)/day_count << F("us, ");
+
+  Serial.flush();
+  start = micros();
+  for (uint16_t i = day_count; i > 0; i--)
+    sink = loop_days( t );
+  end = micros();
+  Serial << (end-start)/day_count << F("us with loops\n");
+}
+
+//--------------------------
+
+void setup()
+{
+  // Start the normal trace output
+  Serial.begin(9600);
+  Serial.println( F("NeoTimeBenchmark: started") );
+
+  #ifdef TIME_EPOCH_MODIFIABLE
+    time_t::epoch_year   ( time_t::Y2K_EPOCH_YEAR );
+    time_t::epoch_weekday( time_t::Y2K_EPOCH_WEEKDAY );
+  #endif
+
+  for (uint16_t y = FIRST_YEAR; y <= LAST_YEAR; y++)
+    day_count += time_t::days_per( y );
+
+  check();
+  time_it();
+}
+
+//--------------------------
+
+void loop() {}
@@ -0,0 +1,151 @@
+#include <Arduino.h>
+#include "ubxGPS.h"
+#include "ubxSim.h"
+
+//======================================================================
+//  Program: ubloxSimBenchmark.ino
+//
+//  Prerequisites:
+//     1) You have installed the ubxGPS.*, ubxmsg.* and ubxSim.* files.
+//     2) At least one UBX NAV message has been enabled in ubxGPS.h.
+//
+//  Description:  Use the simulated ublox receiver to test the UBX
+//     parser's performance, without a device.
+//
+//     Each configured NAV message is enabled in the simulator, and
+//     the NMEA sentences are disabled.  Each epoch is generated
+//     immediately and then decoded; the average and longest decode
+//     times are displayed in microseconds.  The second pass corrupts
+//     some of the messages to test the error handling.
+//
+//  'Serial' is for debug output to the Serial Monitor window.
+//
+//======================================================================
+
+#include "Streamers.h"
+
+#if !defined(UBLOX_PARSE_STATUS) & !defined(UBLOX_PARSE_TIMEGPS) & \
+    !defined(UBLOX_PARSE_TIMEUTC) & !defined(UBLOX_PARSE_POSLLH) & \
+    !defined(UBLOX_PARSE_VELNED) & !defined(UBLOX_PARSE_PVT)
+
+  #error No UBX NAV messages enabled: nothing to benchmark.
+
+#endif
+
+//--------------------------
+
+class BenchGPS : public ubloxGPS
+{
+public:
+    uint32_t completed;
+
+    BenchGPS( Stream *device ) : ubloxGPS( device ), completed( 0 ) {}
+
+    void run()
+    {
+      while (Device()->available())
+        if (decode( Device()->read() ) == DECODE_COMPLETED)
+          completed++;
+    }
+};
+
+static ubloxSimulator sim;
+static BenchGPS       gps( &sim );
+
+//--------------------------
+
+static void enable( ublox::msg_id_t msg_id )
+{
+  if (!gps.enable_msg( ublox::UBX_NAV, msg_id ))
+    Serial << F("enable ") << (uint8_t) msg_id << F(" failed!\n");
+}
+
+//--------------------------
+
+static void time_epochs( const __FlashStringHelper *label )
+{
+  const uint16_t EPOCHS = 256;
+  uint32_t chars    = 0;
+  uint32_t total    = 0;
+  uint32_t longest  = 0;
+  uint32_t messages = gps.completed;
+
+  Serial.flush();
+  for (uint16_t i=EPOCHS; i > 0; i--) {
+    sim.epoch();
+    chars += sim.available();
+
+    uint32_t start = micros();
+    gps.run();
+    uint32_t us = micros() - start;
+
+    total += us;
+    if (longest < us)
+      longest = us;
+  }
+  messages = gps.completed - messages;
+
+  Serial << label << F(": ") << chars << F(" chars, ")
+         << messages << F(" messages, ")
+         << (total/EPOCHS) << F("us/epoch (max ") << longest << F("us), ")
+         << (total/messages) << F("us/message\n");
+  trace_all( Serial, gps, gps.fix() );
+}
+
+//--------------------------
+
+void setup()
+{
+  // Start the normal trace output
+  Serial.begin(9600);
+  Serial.println( F("ubloxSimBenchmark: started") );
+  Serial << F("fix object size = ") << sizeof(gps.fix()) << '\n';
+  Serial << F("ubloxGPS object size = ") << sizeof(ubloxGPS) << '\n';
+
+  ublox::configNMEA( gps, NMEAGPS::NMEA_GGA, 0 );
+  ublox::configNMEA( gps, NMEAGPS::NMEA_RMC, 0 );
+
+  #ifdef UBLOX_PARSE_STATUS
+    enable( ublox::UBX_NAV_STATUS );
+  #endif
+  #ifdef UBLOX_PARSE_TIMEGPS
+    enable( ublox::UBX_NAV_TIMEGPS );
+  #endif
+  #ifdef UBLOX_PARSE_TIMEUTC
+    enable( ublox::UBX_NAV_TIMEUTC );
+  #endif
+  #ifdef UBLOX_PARSE_POSLLH
+    enable( ublox::UBX_NAV_POSLLH );
+  #endif
+  #ifdef UBLOX_PARSE_VELNED
+    enable( ublox::UBX_NAV_VELNED );
+  #endif
+  #ifdef UBLOX_PARSE_PVT
+    enable( ublox::UBX_NAV_PVT );
+  #endif
+
+  // Discard the replies to the configuration commands
+  gps.run();
+
+  trace_header( Serial );
+
+  Serial.flush();
+}
+
+//--------------------------
+
+void loop()
+{
+  sim.corrupt_every = 0;
+  time_epochs( F("UBX") );
+
+  sim.corrupt_every = 8;
+  uint32_t corrupted = sim.corrupted;
+  time_epochs( F("UBX, 1 of 8 corrupted") );
+  Serial << (sim.corrupted - corrupted) << F(" messages corrupted\n");
+
+  if (sim.overruns)
+    Serial << sim.overruns << F(" chars dropped!  Increase UBLOX_SIM_BUFFER_SIZE.\n");
+
+  for (;;);
+}
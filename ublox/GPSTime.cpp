@@ -2,3 +2,118 @@
 
 uint8_t         GPSTime::leap_seconds    = 0;
 NeoGPS::clock_t GPSTime::s_start_of_week = 0;
+
+NeoGPS::clock_t GPSTime::s_last_gps      = 0;
+uint8_t         GPSTime::s_last_leap     = 0;
+NeoGPS::time_t  GPSTime::s_last_utc;
+
+//----------------------------------------------------------------
+//  GPS days (since January 6, 1980) when GPS-UTC became index+1 seconds.
+//  The last entry is January 1, 2017 (18 seconds).
+
+static const uint16_t leap_days[] __PROGMEM = {
+    542,   907,  1272,  2003,  2917,  3648,  4013,  4560,  4925,
+   5290,  5839,  6386,  6935,  9492, 10588, 11865, 12960, 13510
+};
+
+static const uint8_t LEAP_ENTRIES = sizeof(leap_days)/sizeof(leap_days[0]);
+
+uint8_t GPSTime::leap_seconds_at( NeoGPS::clock_t gps_time )
+{
+  uint32_t gps_s = gps_time + gps_epoch_offset();
+  uint8_t  leaps = LEAP_ENTRIES;
+
+  // Most times are after the last entry, so search backwards.
+  while (leaps > 0) {
+    uint32_t leap_start =
+      pgm_read_word( &leap_days[ leaps-1 ] ) * NeoGPS::SECONDS_PER_DAY + leaps;
+    if (gps_s >= leap_start)
+      break;
+    leaps--;
+  }
+
+  return leaps;
+
+} // leap_seconds_at
+
+//----------------------------------------------------------------
+
+uint16_t GPSTime::full_week( uint16_t week )
+{
+  const uint16_t WEEK_ROLLOVER = 1024;
+  const uint16_t pivot_week    =
+    pgm_read_word( &leap_days[ LEAP_ENTRIES-1 ] ) / NeoGPS::DAYS_PER_WEEK;
+
+  week %= WEEK_ROLLOVER;
+  week += pivot_week - (pivot_week % WEEK_ROLLOVER);
+  if (week < pivot_week)
+    week += WEEK_ROLLOVER;
+
+  return week;
+
+} // full_week
+
+//----------------------------------------------------------------
+//  Advance the time of day without changing the date.  Returns false
+//  if midnight would be crossed.
+
+bool GPSTime::advance( NeoGPS::time_t & t, uint8_t seconds )
+{
+  seconds += t.seconds;
+  if (seconds < NeoGPS::SECONDS_PER_MINUTE) {
+    t.seconds = seconds;
+    return true;
+  }
+
+  uint8_t minutes = t.minutes + 1;
+  uint8_t hours   = t.hours;
+  if (minutes == NeoGPS::MINUTES_PER_HOUR) {
+    minutes = 0;
+    if (++hours == NeoGPS::HOURS_PER_DAY)
+      return false;
+  }
+
+  t.seconds = seconds - NeoGPS::SECONDS_PER_MINUTE;
+  t.minutes = minutes;
+  t.hours   = hours;
+
+  return true;
+
+} // advance
+
+//----------------------------------------------------------------
+
+bool GPSTime::from_TOWms
+  ( uint32_t time_of_week_ms, NeoGPS::time_t &dt, uint16_t &ms )
+{
+  if (start_of_week() == 0)
+    return false;
+
+  uint32_t tow_s = time_of_week_ms/1000UL;
+  ms = (uint16_t)(time_of_week_ms - tow_s*1000UL);
+
+  NeoGPS::clock_t gps_time = start_of_week() + tow_s;
+
+  // The time of week started over, but nobody has set the new week yet.
+  if ((s_last_gps != 0) &&
+      (gps_time + SECONDS_PER_WEEK/2 <  s_last_gps) &&
+      (gps_time + SECONDS_PER_WEEK   >= s_last_gps)) {
+    s_start_of_week += SECONDS_PER_WEEK;
+    gps_time        += SECONDS_PER_WEEK;
+  }
+
+  uint8_t         leap  = utc_offset( gps_time );
+  NeoGPS::clock_t delta = gps_time - s_last_gps;
+
+  if ((s_last_gps == 0) || (leap != s_last_leap) ||
+      (delta >= NeoGPS::SECONDS_PER_MINUTE) ||
+      !advance( s_last_utc, delta ))
+    s_last_utc = gps_time - leap;
+
+  s_last_gps  = gps_time;
+  s_last_leap = leap;
+  dt          = s_last_utc;
+
+  return true;
+
+} // from_TOWms
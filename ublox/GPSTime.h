@@ -9,15 +9,70 @@ class GPSTime
 
   static NeoGPS::clock_t s_start_of_week;
 
+  // Last result of from_TOWms, carried forward to the next message.
+  static NeoGPS::clock_t s_last_gps;
+  static uint8_t         s_last_leap;
+  static NeoGPS::time_t  s_last_utc;
+
+  static bool advance( NeoGPS::time_t & t, uint8_t seconds );
+
 public:
 
+    static const uint32_t SECONDS_PER_WEEK =
+      NeoGPS::SECONDS_PER_DAY * NeoGPS::DAYS_PER_WEEK;
+
     /**
      * GPS time is offset from UTC by a number of leap seconds.  To convert a GPS
      * time to UTC time, the current number of leap seconds must be known.
      * See http://en.wikipedia.org/wiki/Global_Positioning_System#Leap_seconds
+     *
+     * This is set from the receiver, if possible.  When it is 0, the
+     * built-in leap second table is used instead (see /leap_seconds_at/).
      */
     static uint8_t leap_seconds;
 
+    /**
+     * Look up the number of leap seconds in the built-in table.
+     * @param[in] gps_time GPS seconds since the NeoGPS epoch
+     *   (i.e., start_of_week() + time_of_week).
+     * @return GPS-UTC, in seconds.
+     */
+    static uint8_t leap_seconds_at( NeoGPS::clock_t gps_time );
+
+    /**
+     * @return the receiver's leap seconds if known, otherwise the
+     *   number from the built-in table.
+     */
+    static uint8_t utc_offset( NeoGPS::clock_t gps_time )
+    {
+      return leap_seconds ? leap_seconds : leap_seconds_at( gps_time );
+    }
+
+    /**
+     * Seconds from the GPS epoch (January 6, 1980) to the NeoGPS epoch.
+     * This is a constant unless TIME_EPOCH_MODIFIABLE is defined.
+     */
+    static int64_t gps_epoch_offset()
+    {
+      const uint16_t GPS_EPOCH_YEAR = 1980;
+      const uint8_t  GPS_EPOCH_DAYS = 5; // January 6 is day 5
+      int32_t days =
+        (int32_t) ((int16_t) (NeoGPS::time_t::epoch_year() - GPS_EPOCH_YEAR)) * 365 +
+        (int16_t) (NeoGPS::time_t::leaps_before( NeoGPS::time_t::epoch_year() ) -
+                   NeoGPS::time_t::leaps_before( GPS_EPOCH_YEAR )) -
+        GPS_EPOCH_DAYS;
+      return days * (int64_t) NeoGPS::SECONDS_PER_DAY;
+    }
+
+    /**
+     * Some receivers only report the GPS week modulo 1024.  This resolves
+     * a week number to the first full week number that is not earlier
+     * than the last entry in the leap second table.
+     * @param[in] week GPS week number, full or modulo 1024.
+     * @return full GPS week number.
+     */
+    static uint16_t full_week( uint16_t week );
+
     /**
      * Some receivers report time WRT start of the current week, defined as
      * Sunday 00:00:00.  To save fairly expensive date/time calculations,
@@ -34,6 +89,16 @@ public:
                                 now.seconds);
       }
 
+    /**
+     * Set the start of week from a GPS week number.  No calendar
+     * calculations are required.
+     * @param[in] week GPS week number, full or modulo 1024.
+     */
+    static void start_of_week( uint16_t week )
+      {
+        s_start_of_week = full_week( week ) * SECONDS_PER_WEEK - gps_epoch_offset();
+      }
+
     static NeoGPS::clock_t start_of_week()
     {
       return s_start_of_week;
@@ -41,28 +106,50 @@ public:
 
     /*
      * Convert a GPS time-of-week to UTC.
-     * Requires /leap_seconds/ and /start_of_week/.
+     * Requires /start_of_week/.
      */
     static NeoGPS::clock_t TOW_to_UTC( uint32_t time_of_week )
-      { return (NeoGPS::clock_t)
-          (start_of_week() + time_of_week - leap_seconds); }
+      {
+        NeoGPS::clock_t gps_time = start_of_week() + time_of_week;
+        return gps_time - utc_offset( gps_time );
+      }
 
     /**
      * Set /fix/ timestamp from a GPS time-of-week in milliseconds.
-     * Requires /leap_seconds/ and /start_of_week/.
+     * Requires /start_of_week/.
+     *
+     * The previous result is carried forward: when the new time is a
+     * few seconds later on the same UTC day, the seconds, minutes and
+     * hours are advanced instead of recalculating the date.  When the
+     * time of week wraps to the next week, /start_of_week/ is advanced.
      **/
     static bool from_TOWms
-      ( uint32_t time_of_week_ms, NeoGPS::time_t &dt, uint16_t &ms )
+      ( uint32_t time_of_week_ms, NeoGPS::time_t &dt, uint16_t &ms );
+
+    /**
+     * Convert a GPS time-of-week in milliseconds to a UTC timestamp.
+     * Requires /start_of_week/.
+     **/
+    static NeoGPS::timestamp_t TOWms_to_timestamp( uint32_t time_of_week_ms )
     {
-//trace << PSTR("from_TOWms(") << time_of_week_ms << PSTR("), sow = ") << start_of_week() << PSTR(", leap = ") << leap_seconds << endl;
-      bool ok = (start_of_week() != 0) && (leap_seconds != 0);
-      if (ok) {
-        NeoGPS::clock_t tow_s = time_of_week_ms/1000UL;
-        dt = TOW_to_UTC( tow_s ); 
-        ms = (uint16_t)(time_of_week_ms - tow_s*1000UL);
-      }
-      return ok;
+      NeoGPS::clock_t gps_time = start_of_week() + time_of_week_ms/1000UL;
+      NeoGPS::timestamp_t ts( start_of_week() );
+      ts += ((int32_t) time_of_week_ms - utc_offset( gps_time ) * 1000L) *
+              (int64_t) NeoGPS::timestamp_t::US_PER_MS;
+      return ts;
+    }
+
+    /**
+     * Convert a UTC timestamp to a GPS time-of-week in milliseconds,
+     * relative to the current /start_of_week/.
+     * Requires /start_of_week/.
+     **/
+    static uint32_t TOWms( const NeoGPS::timestamp_t & ts )
+    {
+      int64_t since_sow = ts - NeoGPS::timestamp_t( start_of_week() );
+      return (since_sow / NeoGPS::timestamp_t::US_PER_MS) +
+               utc_offset( ts.seconds() ) * 1000UL;
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -17,6 +17,13 @@
 
 #endif
 
+#if defined( UBLOX_PARSE_PVT ) & !defined( NMEAGPS_PARSING_SCRATCHPAD )
+
+  // The NAV_PVT message also has the 4-byte nanoseconds of the time.
+  #error You must enable NMEAGPS_PARSING_SCRATCHPAD in NMEAGPS_cfg.h
+
+#endif
+
 using namespace ublox;
 
 //----------------------------------
@@ -26,6 +33,49 @@ void ubloxGPS::rxBegin()
   m_rx_msg.init();
   storage = (msg_t *) NULL;
   chrCount = 0;
+  #if UBLOX_REQUEST_QUEUE_SIZE > 0
+    m_acked.msg_class = UBX_UNK;
+    m_acked.msg_id    = UBX_ID_UNK;
+  #endif
+  #if UBLOX_STORAGE_TABLE_SIZE > 0
+    m_stored_rx = UBLOX_STORAGE_TABLE_SIZE;
+  #endif
+}
+
+//  Decide where the payload of the received message is stored:
+//  a blocking reply, a queued reply, a /raw/ slot, a registered
+//  buffer, or /storage_for/.
+
+void ubloxGPS::rxStorage()
+{
+  if (reply_expected && rx().same_kind( *reply )) {
+    storage = reply;
+    return;
+  }
+
+  #if UBLOX_REQUEST_QUEUE_SIZE > 0
+    uint8_t i = oldest_request( rx(), false );
+    if (i < UBLOX_REQUEST_QUEUE_SIZE) {
+      storage = m_requests[i].reply;
+      return;
+    }
+  #endif
+
+  #ifdef UBLOX_PARSE_RAW
+    storage = raw.storage_for( rx() );
+    if (storage)
+      return;
+  #endif
+
+  #if UBLOX_STORAGE_TABLE_SIZE > 0
+    uint8_t entry = find_stored( rx() );
+    if (entry < UBLOX_STORAGE_TABLE_SIZE) {
+      storage = stored_storage( entry );
+      return;
+    }
+  #endif
+
+  storage = storage_for( rx() );
 }
 
 bool ubloxGPS::rxEnd()
@@ -44,6 +94,10 @@ bool ubloxGPS::rxEnd()
       ack_expected = false;
     }
 
+    #if UBLOX_REQUEST_QUEUE_SIZE > 0
+      ack_request( rx().msg_id == UBX_ACK_ACK );
+    #endif
+
   } else if (rx().msg_class != UBX_UNK) {
 
     #ifdef NMEAGPS_STATS
@@ -64,6 +118,24 @@ bool ubloxGPS::rxEnd()
         storage->msg_id    = rx().msg_id;
         if (storage->length > rx().length)
           storage->length    = rx().length;
+
+        #if UBLOX_REQUEST_QUEUE_SIZE > 0
+          uint8_t i = oldest_request( rx(), false );
+          if ((i < UBLOX_REQUEST_QUEUE_SIZE) && (m_requests[i].reply == storage)) {
+            m_requests[i].reply_expected = false;
+            if (!m_requests[i].ack_expected)
+              request_complete( i, REQUEST_OK );
+            visible_msg = false;
+          }
+        #endif
+
+        #ifdef UBLOX_PARSE_RAW
+          raw.commit( storage );
+        #endif
+
+        #if UBLOX_STORAGE_TABLE_SIZE > 0
+          stored_commit();
+        #endif
       }
       storage = (msg_t *) NULL;
     }
@@ -89,9 +161,12 @@ ubloxGPS::decode_t ubloxGPS::decode( char c )
 
       case UBX_IDLE:
 //if ((c != '\r') && (c != '\n')) trace << toHexDigit(c >> 4) << toHexDigit(c);
-        if (chr == SYNC_1)
+        if (chr == SYNC_1) {
           rxState = (rxState_t) UBX_SYNC2;
-        else
+          #ifdef GPS_FIX_RX_TIME
+            rxTimeBegin();
+          #endif
+        } else
           res = DECODE_CHR_INVALID;
         break;
 
@@ -131,7 +206,7 @@ ubloxGPS::decode_t ubloxGPS::decode( char c )
               break;
             case 3:
               rx().length += chr << 8;
-              if (rx().length > 512) {
+              if (rx().length > UBLOX_MAX_LENGTH) {
                 rxBegin();
                 rxState = (rxState_t) UBX_IDLE;
               }
@@ -144,10 +219,8 @@ ubloxGPS::decode_t ubloxGPS::decode( char c )
               if (rx().msg_class == UBX_ACK) {
                 if (ack_expected)
                   ack_same_as_sent = true; // so far...
-              } else if (reply_expected && rx().same_kind( *reply ))
-                storage = reply;
-              else
-                storage = storage_for( rx() );
+              } else
+                rxStorage();
               break;
           }
           break;
@@ -227,6 +300,143 @@ ubloxGPS::decode_t ubloxGPS::decode( char c )
 }
 
 
+//---------------------------------
+//  A frame is the 2 sync characters, the class, id and 2-byte length,
+//  the payload, and the 2-byte checksum.
+
+ubloxGPS::decode_t ubloxGPS::decode_frame
+  ( const uint8_t *frame, uint16_t len, uint16_t & used )
+{
+  used = 0;
+
+  if ((len > 0) && (frame[0] != SYNC_1))
+    goto invalid;
+  if ((len > 1) && (frame[1] != SYNC_2))
+    goto invalid;
+  if (len < 6)
+    return DECODE_CHR_OK;
+
+  {
+    uint16_t length = frame[4] | (((uint16_t) frame[5]) << 8);
+    if (length > UBLOX_MAX_LENGTH)
+      goto invalid;
+    if (len < length + 8)
+      return DECODE_CHR_OK;
+
+    //  Check the whole frame before anything is changed.
+    uint8_t crc_a = 0;
+    uint8_t crc_b = 0;
+    fletcher8( &frame[2], length + 4, crc_a, crc_b );
+    const uint8_t *crc = &frame[ length + 6 ];
+    if ((crc[0] != crc_a) || (crc[1] != crc_b)) {
+      #ifdef NMEAGPS_STATS
+        statistics.crc_errors++;
+      #endif
+      goto invalid;
+    }
+
+    #ifdef GPS_FIX_RX_TIME
+      rxTimeBegin();
+    #endif
+
+    rxBegin();
+    rx().msg_class = (msg_class_t) frame[2];
+    rx().msg_id    = (msg_id_t)    frame[3];
+    rx().length    = length;
+
+    NMEAGPS_INIT_FIX(m_fix);
+    safe = false;
+
+    const uint8_t *payload = &frame[6];
+
+    if (rx().msg_class == UBX_ACK) {
+      if (ack_expected)
+        ack_same_as_sent = (length >= 2) &&
+                           (payload[0] == sent.msg_class) &&
+                           (payload[1] == sent.msg_id);
+      #if UBLOX_REQUEST_QUEUE_SIZE > 0
+        if (length >= 2) {
+          m_acked.msg_class = (msg_class_t) payload[0];
+          m_acked.msg_id    = (msg_id_t)    payload[1];
+        }
+      #endif
+    } else {
+      rxStorage();
+
+      if (storage)
+        memcpy( ((uint8_t *)storage) + sizeof(msg_t), payload,
+                (storage->length < length) ? storage->length : length );
+    }
+
+    parsePayload( payload );
+
+    used = length + 8;
+    #ifdef NMEAGPS_STATS
+      statistics.chars += used;
+    #endif
+
+    if (!rxEnd())
+      return DECODE_CHR_OK;
+
+    #ifdef GPS_FIX_RX_TIME
+      //  The caller of decode_frame hands off the fix, so each frame
+      //    has its own times.
+      m_fix.rx_start_us     = m_rx_start_us;
+      m_fix.rx_completed_us = micros();
+      m_fix.rx_parse_us     = m_fix.rx_completed_us - m_rx_start_us;
+    #endif
+
+    return DECODE_COMPLETED;
+  }
+
+invalid:
+  used = 1;
+  return DECODE_CHR_INVALID;
+
+} // decode_frame
+
+//---------------------------------
+//  Only the sync characters are examined: UBX frames are passed whole
+//  to /decode_frame/, and NMEA characters go straight to the NMEA
+//  decoder, without the UBX states.  The NMEA decoder keeps its state,
+//  so a sentence can be split across buffers.
+
+ubloxGPS::decode_t ubloxGPS::demux
+  ( const uint8_t *buf, uint16_t len, uint16_t & used )
+{
+  used = 0;
+  if (len == 0)
+    return DECODE_CHR_OK;
+
+  if (buf[0] == SYNC_1) {
+    if (rxState != NMEA_IDLE)
+      NMEAGPS::decode( SYNC_1 ); // the sentence was cut off
+    return decode_frame( buf, len, used );
+  }
+
+  if ((buf[0] == '$') || (rxState != NMEA_IDLE)) {
+    if (rx().msg_class != UBX_UNK)
+      m_rx_msg.init();
+
+    decode_t res;
+    do {
+      res = NMEAGPS::decode( buf[ used++ ] );
+    } while ((res != DECODE_COMPLETED) && (rxState != NMEA_IDLE) &&
+             (used < len) && (buf[ used ] != SYNC_1));
+    return res;
+  }
+
+  //  Skip to the next sync character.
+  while ((used < len) && (buf[ used ] != '$') && (buf[ used ] != SYNC_1))
+    used++;
+  #ifdef NMEAGPS_STATS
+    statistics.chars += used;
+  #endif
+
+  return DECODE_CHR_INVALID;
+
+} // demux
+
 void ubloxGPS::wait_for_idle()
 {
   // Wait for the input buffer to be emptied
@@ -295,18 +505,7 @@ bool ubloxGPS::wait_for_ack()
 
 void ubloxGPS::write( const msg_t & msg )
 {
-  m_device->print( (char) SYNC_1 );
-  m_device->print( (char) SYNC_2 );
-
-  uint8_t  crc_a = 0;
-  uint8_t  crc_b = 0;
-  uint8_t *ptr   = (uint8_t *) &msg;
-  uint16_t l     = msg.length + sizeof(msg_t);
-  while (l--)
-    write( *ptr++, crc_a, crc_b );
-
-  m_device->print( (char) crc_a );
-  m_device->print( (char) crc_b );
+  write_frame( *m_device, (const uint8_t *) &msg, msg.length + sizeof(msg_t), false );
 
   sent.msg_class = msg.msg_class;
   sent.msg_id    = msg.msg_id;
@@ -315,36 +514,32 @@ void ubloxGPS::write( const msg_t & msg )
 
 void ubloxGPS::write_P( const msg_t & msg )
 {
-  m_device->print( (char) SYNC_1 );
-  m_device->print( (char) SYNC_2 );
-
-  uint8_t  crc_a = 0;
-  uint8_t  crc_b = 0;
-  uint8_t *ptr   = (uint8_t *) &msg;
-  uint16_t l     = msg.length + sizeof(msg_t);
-  uint32_t dword;
-
-  while (l > 0) {
-    if (l >= sizeof(dword)) {
-      l -= sizeof(dword);
-      dword = pgm_read_dword( ptr );
-      for (uint8_t i=sizeof(dword); i--;) {
-        write( (uint8_t) dword, crc_a, crc_b );
-        dword >>= 8;
-      }
-      ptr += sizeof(dword);
+  uint16_t length = pgm_read_word( &msg.length );
+  write_frame( *m_device, (const uint8_t *) &msg, length + sizeof(msg_t), true );
 
-    } else {
-      write( pgm_read_byte( ptr++ ), crc_a, crc_b );
-      l--;
-    }
-  }
+  sent.msg_class = (msg_class_t) pgm_read_byte( &msg.msg_class );
+  sent.msg_id    = (msg_id_t)    pgm_read_byte( &msg.msg_id );
+}
 
-  m_device->print( (char) crc_a );
-  m_device->print( (char) crc_b );
+//---------------------------------
+//  The frame is already complete, so it is copied from flash and
+//  written in chunks, without calculating the checksum.
 
-  sent.msg_class = msg.msg_class;
-  sent.msg_id    = msg.msg_id;
+void ubloxGPS::write_frame_P( const uint8_t *frame_P )
+{
+  uint8_t  buf[ 64 ];
+  uint16_t len = pgm_read_word( &frame_P[4] ) + 8;
+
+  sent.msg_class = (msg_class_t) pgm_read_byte( &frame_P[2] );
+  sent.msg_id    = (msg_id_t)    pgm_read_byte( &frame_P[3] );
+
+  while (len) {
+    uint8_t count = (len < sizeof(buf)) ? len : sizeof(buf);
+    memcpy_P( buf, frame_P, count );
+    m_device->write( buf, count );
+    frame_P += count;
+    len     -= count;
+  }
 }
 
 /**
@@ -355,11 +550,37 @@ void ubloxGPS::write_P( const msg_t & msg )
 bool ubloxGPS::send( const msg_t & msg, msg_t *reply_msg )
 {
 //trace << F("::send - ") << (uint8_t) msg.msg_class << F(" ") << (uint8_t) msg.msg_id << F(" ");
+  write( msg );
+
+  return wait_for_reply( reply_msg );
+}
+
+bool ubloxGPS::send_P( const msg_t & msg, msg_t *reply_msg )
+{
+  write_P( msg );
+
+  return wait_for_reply( reply_msg );
+}
+
+bool ubloxGPS::send_frame_P( const uint8_t *frame_P, msg_t *reply_msg )
+{
+  write_frame_P( frame_P );
+
+  return wait_for_reply( reply_msg );
+}
+
+//---------------------------------
+//  The /sent/ message has just been written.  Wait for its ACK and/or
+//  the reply.
+
+bool ubloxGPS::wait_for_reply( msg_t *reply_msg )
+{
   bool ok = true;
 
-  write( msg );
+  //  Forget any reply to an earlier poll, or a NAK would look successful.
+  reply_received = false;
 
-  if (msg.msg_class == UBX_CFG) {
+  if (sent.msg_class == UBX_CFG) {
     ack_received = false;
     nak_received = false;
     ack_same_as_sent = false;
@@ -368,7 +589,6 @@ bool ubloxGPS::send( const msg_t & msg, msg_t *reply_msg )
 
   if (reply_msg) {
     reply = reply_msg;
-    reply_received = false;
     reply_expected = true;
   }
 
@@ -391,14 +611,306 @@ bool ubloxGPS::send( const msg_t & msg, msg_t *reply_msg )
   return ok;
 }
 
+#if UBLOX_REQUEST_QUEUE_SIZE > 0
 
-bool ubloxGPS::send_P( const msg_t & msg, msg_t *reply_msg )
+//---------------------------------------------
+//  Requests are sent immediately, and their ACKs and replies are
+//  matched as messages are received.  If several requests have the
+//  same class and id, the oldest one is matched first.
+
+bool ubloxGPS::queue_request
+  ( const msg_t & msg, msg_t *reply_msg, uint16_t timeout_ms )
+{
+  if (!add_request( msg, reply_msg, timeout_ms ))
+    return false;
+
+  write( msg );
+  return true;
+}
+
+bool ubloxGPS::queue_request_P
+  ( const msg_t & msg, msg_t *reply_msg, uint16_t timeout_ms )
+{
+  msg_hdr_t hdr;
+  hdr.msg_class = (msg_class_t) pgm_read_byte( &msg.msg_class );
+  hdr.msg_id    = (msg_id_t)    pgm_read_byte( &msg.msg_id );
+
+  if (!add_request( hdr, reply_msg, timeout_ms ))
+    return false;
+
+  write_P( msg );
+  return true;
+}
+
+bool ubloxGPS::queue_frame_P
+  ( const uint8_t *frame_P, msg_t *reply_msg, uint16_t timeout_ms )
+{
+  msg_hdr_t hdr;
+  hdr.msg_class = (msg_class_t) pgm_read_byte( &frame_P[2] );
+  hdr.msg_id    = (msg_id_t)    pgm_read_byte( &frame_P[3] );
+
+  if (!add_request( hdr, reply_msg, timeout_ms ))
+    return false;
+
+  write_frame_P( frame_P );
+  return true;
+}
+
+bool ubloxGPS::add_request
+  ( msg_hdr_t msg, msg_t *reply_msg, uint16_t timeout_ms )
+{
+  bool ack = (msg.msg_class == UBX_CFG);
+
+  if (!ack && !reply_msg)
+    return true; // nothing to wait for
+
+  for (uint8_t i=0; i < UBLOX_REQUEST_QUEUE_SIZE; i++) {
+    request_t & r = m_requests[i];
+    if (!r.pending) {
+      r.msg            = msg;
+      r.reply          = reply_msg;
+      r.sent_ms        = millis();
+      r.timeout_ms     = timeout_ms;
+      r.ack_expected   = ack;
+      r.reply_expected = (reply_msg != NULL);
+      r.pending        = true;
+      return true;
+    }
+  }
+
+  return false;
+
+} // add_request
+
+//  Find the oldest pending request for /msg/ that is waiting for an
+//  ACK or a reply.  Returns UBLOX_REQUEST_QUEUE_SIZE if there is none.
+
+uint8_t ubloxGPS::oldest_request( const msg_hdr_t & msg, bool ack )
+{
+  uint8_t  oldest = UBLOX_REQUEST_QUEUE_SIZE;
+  uint16_t oldest_age = 0;
+  uint16_t ms = millis();
+
+  for (uint8_t i=0; i < UBLOX_REQUEST_QUEUE_SIZE; i++) {
+    const request_t & r = m_requests[i];
+    if (r.pending &&
+        (ack ? r.ack_expected : r.reply_expected) &&
+        r.msg.same_kind( msg )) {
+      uint16_t age = ms - r.sent_ms;
+      if ((oldest == UBLOX_REQUEST_QUEUE_SIZE) || (age > oldest_age)) {
+        oldest     = i;
+        oldest_age = age;
+      }
+    }
+  }
+
+  return oldest;
+
+} // oldest_request
+
+void ubloxGPS::ack_request( bool acked )
+{
+  uint8_t i = oldest_request( m_acked, true );
+
+  if (i < UBLOX_REQUEST_QUEUE_SIZE) {
+    m_requests[i].ack_expected = false;
+    if (!acked)
+      request_complete( i, REQUEST_NAK ); // a NAKed poll is not answered
+    else if (!m_requests[i].reply_expected)
+      request_complete( i, REQUEST_OK );
+  }
+}
+
+void ubloxGPS::request_complete( uint8_t i, request_result_t result )
+{
+  request_t & r = m_requests[i];
+  r.pending = false;
+  if (result != REQUEST_OK)
+    m_request_failures++;
+
+  request_done( r.msg, r.reply, result );
+}
+
+void ubloxGPS::check_requests()
+{
+  uint16_t ms = millis();
+
+  for (uint8_t i=0; i < UBLOX_REQUEST_QUEUE_SIZE; i++) {
+    const request_t & r = m_requests[i];
+    if (r.pending && ((uint16_t)(ms - r.sent_ms) >= r.timeout_ms))
+      request_complete( i, REQUEST_TIMEOUT );
+  }
+}
+
+uint8_t ubloxGPS::requests_pending() const
+{
+  uint8_t count = 0;
+  for (uint8_t i=0; i < UBLOX_REQUEST_QUEUE_SIZE; i++)
+    if (m_requests[i].pending)
+      count++;
+  return count;
+}
+
+#endif
+
+#if UBLOX_STORAGE_TABLE_SIZE > 0
+
+//---------------------------------------------
+//  Registered storage does not need interrupts to be disabled.  Each
+//  message is received into a buffer that the application has not
+//  locked, and it is only published in /ready/ when the frame is
+//  complete.  The application locks the /ready/ buffer, then checks
+//  that it was not being overwritten in the meantime.
+
+bool ubloxGPS::store( msg_t & msg )
+{
+  return add_stored( msg, (msg_t *) NULL );
+}
+
+bool ubloxGPS::store( msg_t & msg, msg_t & msg2 )
+{
+  if (!msg.same_kind( msg2 ) || (msg.length != msg2.length))
+    return false;
+
+  return add_stored( msg, &msg2 );
+}
+
+bool ubloxGPS::add_stored( msg_t & msg, msg_t *msg2 )
 {
+  if ((m_stored_count == UBLOX_STORAGE_TABLE_SIZE) ||
+      (find_stored( msg ) < UBLOX_STORAGE_TABLE_SIZE))
     return false;
+
+  stored_t & s = m_stored[ m_stored_count ];
+  s.msg.msg_class = msg.msg_class;
+  s.msg.msg_id    = msg.msg_id;
+  s.length        = msg.length;
+  s.buffer[0]     = &msg;
+  s.buffer[1]     = msg2;
+  s.ready         = NO_BUFFER;
+  s.reading       = NO_BUFFER;
+  s.updates       = 0;
+  s.seen          = 0;
+
+  m_stored_count++; // now it can be found
+
+  return true;
+
+} // add_stored
+
+//  Returns UBLOX_STORAGE_TABLE_SIZE if /msg/ is not stored.
+
+uint8_t ubloxGPS::find_stored( const msg_hdr_t & msg ) const
+{
+  for (uint8_t i=0; i < m_stored_count; i++)
+    if (m_stored[i].msg.same_kind( msg ))
+      return i;
+
+  return UBLOX_STORAGE_TABLE_SIZE;
+}
+
+//  Choose the buffer for the message being received: not the locked
+//  one, and not the last complete copy if there is another.  Returns
+//  NULL if the only buffer is locked.
+
+msg_t *ubloxGPS::stored_storage( uint8_t i )
+{
+  stored_t & s       = m_stored[i];
+  uint8_t    reading = s.reading;
+  uint8_t    w;
+
+  if (!s.buffer[1]) {
+    if (reading == 0) {
+      m_stored_drops++;
+      return (msg_t *) NULL;
+    }
+    w = 0;
+  } else if (reading != NO_BUFFER)
+    w = reading ^ 1;
+  else
+    w = (s.ready == 0) ? 1 : 0;
+
+  if (s.ready == w)
+    s.ready = NO_BUFFER; // it is about to be overwritten
+
+  s.writing   = w;
+  m_stored_rx = i;
+
+  msg_t *buf  = s.buffer[w];
+  buf->length = s.length; // rxEnd reduces it to the received length
+  return buf;
+
+} // stored_storage
+
+void ubloxGPS::stored_commit()
+{
+  if (m_stored_rx < UBLOX_STORAGE_TABLE_SIZE) {
+    stored_t & s = m_stored[ m_stored_rx ];
+    s.ready = s.writing;
+    s.updates++;
+    m_stored_rx = UBLOX_STORAGE_TABLE_SIZE;
+  }
+}
+
+const msg_t *ubloxGPS::lock_stored( msg_class_t msg_class, msg_id_t msg_id )
+{
+  msg_hdr_t msg;
+  msg.msg_class = msg_class;
+  msg.msg_id    = msg_id;
+
+  uint8_t i = find_stored( msg );
+  if (i == UBLOX_STORAGE_TABLE_SIZE)
+    return (const msg_t *) NULL;
+
+  stored_t & s = m_stored[i];
+  s.seen = s.updates; // a copy completed after this is still available
+
+  for (;;) {
+    uint8_t r = s.ready;
+    s.reading = r;
+    if (r == NO_BUFFER)
+      return (const msg_t *) NULL;
+    if (s.ready == r)
+      return s.buffer[r]; // and /decode/ will not choose it now
+  }
+
+} // lock_stored
+
+void ubloxGPS::unlock_stored( msg_class_t msg_class, msg_id_t msg_id )
+{
+  msg_hdr_t msg;
+  msg.msg_class = msg_class;
+  msg.msg_id    = msg_id;
+
+  uint8_t i = find_stored( msg );
+  if (i < UBLOX_STORAGE_TABLE_SIZE)
+    m_stored[i].reading = NO_BUFFER;
 }
 
+bool ubloxGPS::stored_available( msg_class_t msg_class, msg_id_t msg_id ) const
+{
+  msg_hdr_t msg;
+  msg.msg_class = msg_class;
+  msg.msg_id    = msg_id;
+
+  uint8_t i = find_stored( msg );
+  return (i < UBLOX_STORAGE_TABLE_SIZE) &&
+         (m_stored[i].updates != m_stored[i].seen);
+}
+
+#endif
+
 //---------------------------------------------
 
+#if defined(UBLOX_PARSE_PVT) & defined(GPS_FIX_PDOP)
+  //  The NAV-PVT DOP is x0.01, but gps_fix uses x0.001.  Large values
+  //  are limited to 65.535.
+  static uint16_t pdop_E3( uint16_t pdop_E2 )
+  {
+    return (pdop_E2 > 0xFFFF/10) ? 0xFFFF : pdop_E2 * 10;
+  }
+#endif
+
 bool ubloxGPS::parseField( char c )
 {
     uint8_t chr = c;
@@ -486,12 +998,7 @@ bool ubloxGPS::parseField( char c )
                       gps_fix::whole_frac *altp = &m_fix.alt;
                       int32_t height_MSLmm = *((int32_t *)altp);
 //trace << F(" alt = ") << height_MSLmm;
-                      m_fix.alt.whole = height_MSLmm / 1000UL;
-                      m_fix.alt.frac  = ((uint16_t)(height_MSLmm - (m_fix.alt.whole * 1000UL)))/10;
-//trace << F(" = ") << m_fix.alt.whole << F(".");
-//if (m_fix.alt.frac < 10) trace << '0';
-//trace << m_fix.alt.frac;
-                      m_fix.valid.altitude = true;
+                      setAltitude( height_MSLmm );
                     }
                     break;
                 #endif
@@ -507,9 +1014,9 @@ bool ubloxGPS::parseField( char c )
                     #endif
                     // fall through...
                   case 21: case 22: case 23:
-                    U1[ chrCount-20 ] = chr;
+                    scratchpad.U1[ chrCount-20 ] = chr;
                     if (chrCount == 23) {
-                      uint16_t err_cm = U4/100;
+                      uint16_t err_cm = scratchpad.U4/100;
 
                       #ifdef GPS_FIX_LAT_ERR
                         m_fix.lat_err_cm = err_cm;
@@ -528,9 +1035,9 @@ bool ubloxGPS::parseField( char c )
                   case 24:
                     NMEAGPS_INVALIDATE( alt_err );
                   case 25: case 26: case 27:
-                    U1[ chrCount-24 ] = chr;
+                    scratchpad.U1[ chrCount-24 ] = chr;
                     if (chrCount == 27) {
-                      m_fix.alt_err_cm = U4/100;
+                      m_fix.alt_err_cm = scratchpad.U4/100;
                       m_fix.valid.alt_err = true;
                     }
                     break;
@@ -549,7 +1056,7 @@ bool ubloxGPS::parseField( char c )
                   break;
 
                 #ifdef GPS_FIX_SPEED
-                  //  Use the speed_3D field at offset 20
+                  //  Use the speed_2D (ground speed) field at offset 20
                   case 20:
                     NMEAGPS_INVALIDATE( speed );
                   case 21: case 22: case 23:
@@ -561,26 +1068,7 @@ bool ubloxGPS::parseField( char c )
 //trace << F("spd = ");
 //trace << (*((uint32_t *)spdp));
 //trace << F(" cm/s, ");
-                      // Convert the 32-bit cm/s to nautical miles per hour
-                      //   (actually, 1000nmi/h limit is 51444, a 16-bit cm/s)
-                      // Conversion factor:
-                      //     = cm/s * (3600s/1hr) * (1m/100cm) * (1nmi/1852m)
-                      //     = cm/s * 36/1852
-                      //     = cm/s * 0.0194384449
-                      //   Fixed point math:
-                      //     0.0194384449 * 2^19 = 10191.343 (14 bits)
-
-                      const uint32_t FACTOR_E19 = 10191UL;
-                      uint32_t nmiph_E19 = (*((uint32_t *)spdp) * FACTOR_E19);
-                      m_fix.spd.whole = (nmiph_E19 >> 19);
-
-                      // remove whole part, leaving fractional part
-                      nmiph_E19 -= ((uint32_t)m_fix.spd.whole) << 19;
-
-                      //m_fix.spd.frac = (nmiph_E19 * 1000UL) >> 19;
-                      m_fix.spd.frac   = (nmiph_E19 * 125)    >> 16;
-
-                      m_fix.valid.speed = true;
+                      setSpeed( *((uint32_t *)spdp) );
 //trace << m_fix.speed_mkn() << F(" nmi/h ");
                     }
                     break;
@@ -597,11 +1085,7 @@ bool ubloxGPS::parseField( char c )
 //trace << F("hdg ");
 //trace << ui;
 //trace << F("E-5, ");
-
-                      m_fix.hdg.whole = ui / 100000UL;
-                      ui -= ((uint32_t)m_fix.hdg.whole) * 100000UL;
-                      m_fix.hdg.frac  = (ui/1000UL);  // hundredths
-                      m_fix.valid.heading = true;
+                      setHeading( ui );
 //trace << m_fix.heading_cd() << F("E-2 ");
                     }
                     break;
@@ -619,6 +1103,12 @@ bool ubloxGPS::parseField( char c )
                   case 0: case 1: case 2: case 3:
                     ok = parseTOW( chr );
                     break;
+                  case 8:
+                    m_week = chr;
+                    break;
+                  case 9:
+                    m_week |= ((uint16_t) chr) << 8;
+                    break;
                   case 10:
                     GPSTime::leap_seconds = (int8_t) chr;
                     break;
@@ -627,17 +1117,13 @@ bool ubloxGPS::parseField( char c )
                       ublox::nav_timegps_t::valid_t &v =
                         *((ublox::nav_timegps_t::valid_t *) &chr);
                       if (!v.leap_seconds)
-                        GPSTime::leap_seconds = 0; // oops!
+                        GPSTime::leap_seconds = 0; // use the built-in table
 //else trace << F("leap ") << GPSTime::leap_seconds << ' ';
-                      if (GPSTime::leap_seconds != 0) {
-                        if (!v.time_of_week) {
-                          m_fix.valid.date =
-                          m_fix.valid.time = false;
-                        } else if ((GPSTime::start_of_week() == 0) &&
-                                   m_fix.valid.date && m_fix.valid.time) {
-                          GPSTime::start_of_week( m_fix.dateTime );
-//trace << m_fix.dateTime << '.' << m_fix.dateTime_cs;
-                        }
+                      if (v.week)
+                        GPSTime::start_of_week( m_week );
+                      if (!v.time_of_week) {
+                        m_fix.valid.date =
+                        m_fix.valid.time = false;
                       }
                     }
                     break;
@@ -683,8 +1169,7 @@ bool ubloxGPS::parseField( char c )
 
                       #if defined(GPS_FIX_TIME) & defined(GPS_FIX_DATE)
                         if (m_fix.valid.date &&
-                            (GPSTime::start_of_week() == 0) &&
-                            (GPSTime::leap_seconds    != 0))
+                            (GPSTime::start_of_week() == 0))
                           GPSTime::start_of_week( m_fix.dateTime );
                       #endif
 //trace << m_fix.dateTime << F(".") << m_fix.dateTime_cs;
@@ -696,6 +1181,215 @@ bool ubloxGPS::parseField( char c )
             #endif
             break;
 
+          case UBX_NAV_PVT: //-----------------------------------------
+            #ifdef UBLOX_PARSE_PVT
+              //  The date and time are in UTC, so the time of week is
+              //  not needed.
+              switch (chrCount) {
+
+                #if defined(GPS_FIX_DATE)
+                  case 4: NMEAGPS_INVALIDATE( date );
+                          m_fix.dateTime.year  = chr; break;
+                  case 5: m_fix.dateTime.year  =
+                            ((((uint16_t)chr) << 8) + m_fix.dateTime.year) % 100;
+                    break;
+                  case 6: m_fix.dateTime.month = chr; break;
+                  case 7: m_fix.dateTime.date  = chr; break;
+                #endif
+
+                #if defined(GPS_FIX_TIME)
+                  case 8: NMEAGPS_INVALIDATE( time );
+                          m_fix.dateTime.hours   = chr; break;
+                  case 9: m_fix.dateTime.minutes = chr; break;
+                  case 10: m_fix.dateTime.seconds = chr; break;
+                #endif
+
+                case 11:
+                  {
+                    ublox::nav_pvt_t::valid_t &v =
+                      *((ublox::nav_pvt_t::valid_t *) &chr);
+
+                    #if defined(GPS_FIX_DATE)
+                      m_fix.valid.date = v.date;
+                    #endif
+                    #if defined(GPS_FIX_TIME)
+                      m_fix.valid.time = v.time;
+                    #endif
+                  }
+                  break;
+
+                #if defined(GPS_FIX_TIME) & defined(GPS_FIX_DATE)
+                  case 16: case 17: case 18: case 19:
+                    scratchpad.U1[ chrCount-16 ] = chr;
+                    if (chrCount == 19)
+                      setFraction( scratchpad.U4 );
+                    break;
+                #endif
+
+                case 20:
+                  ok = parseFix( chr );
+                  break;
+                case 21:
+                  {
+                    //  The first two bits are the same as NAV-STATUS
+                    ublox::nav_status_t::flags_t flags =
+                      *((ublox::nav_status_t::flags_t *) &chr);
+                    m_fix.status =
+                      ublox::nav_status_t::to_status
+                        ( (ublox::nav_status_t::status_t) m_fix.status, flags );
+                  }
+                  break;
+
+                #ifdef GPS_FIX_SATELLITES
+                  case 23:
+                    m_fix.satellites = chr;
+                    m_fix.valid.satellites = true;
+                    break;
+                #endif
+
+                #if defined( GPS_FIX_LOCATION ) | defined( GPS_FIX_LOCATION_DMS )
+                  case 24:
+                    NMEAGPS_INVALIDATE( location );
+                  case 25: case 26: case 27:
+                    #ifdef GPS_FIX_LOCATION
+                      ((uint8_t *)&m_fix.lon) [ chrCount-24 ] = chr;
+                    #else
+                      scratchpad.U1[ chrCount-24 ] = chr;
+                    #endif
+                    if (chrCount == 27) {
+                      #if defined( GPS_FIX_LOCATION ) & defined( GPS_FIX_LOCATION_DMS )
+                        m_fix.longitudeDMS.From( m_fix.lon );
+                      #elif defined( GPS_FIX_LOCATION_DMS )
+                        m_fix.longitudeDMS.From( scratchpad.U4 );
+                      #endif
+                    }
+                    break;
+                  case 28: case 29: case 30: case 31:
+                    #ifdef GPS_FIX_LOCATION
+                      ((uint8_t *)&m_fix.lat) [ chrCount-28 ] = chr;
+                    #else
+                      scratchpad.U1[ chrCount-28 ] = chr;
+                    #endif
+                    if (chrCount == 31) {
+                      #if defined( GPS_FIX_LOCATION ) & defined( GPS_FIX_LOCATION_DMS )
+                        m_fix.latitudeDMS .From( m_fix.lat );
+                      #elif defined( GPS_FIX_LOCATION_DMS )
+                        m_fix.latitudeDMS .From( scratchpad.U4 );
+                      #endif
+                      m_fix.valid.location = true;
+                    }
+                    break;
+                #endif
+
+                #ifdef GPS_FIX_GEOID_HEIGHT
+                  //  Temporarily store the ellipsoid height in geoidHt
+                  case 32:
+                    NMEAGPS_INVALIDATE( geoidHeight );
+                  case 33: case 34: case 35:
+                    ((uint8_t *)&m_fix.geoidHt) [ chrCount-32 ] = chr;
+                    break;
+                #endif
+
+                #if defined( GPS_FIX_ALTITUDE ) | defined( GPS_FIX_GEOID_HEIGHT )
+                  case 36:
+                    #ifdef GPS_FIX_ALTITUDE
+                      NMEAGPS_INVALIDATE( altitude );
+                    #endif
+                  case 37: case 38: case 39:
+                    scratchpad.U1[ chrCount-36 ] = chr;
+                    if (chrCount == 39) {
+                      int32_t height_MSLmm = scratchpad.U4;
+                      #ifdef GPS_FIX_GEOID_HEIGHT
+                        gps_fix::whole_frac *htp = &m_fix.geoidHt;
+                        setGeoidHeight( *((int32_t *)htp) - height_MSLmm );
+                      #endif
+                      #ifdef GPS_FIX_ALTITUDE
+                        setAltitude( height_MSLmm );
+                      #endif
+                    }
+                    break;
+                #endif
+
+                #if defined( GPS_FIX_LAT_ERR ) | defined( GPS_FIX_LON_ERR )
+                  case 40:
+                    #ifdef GPS_FIX_LAT_ERR
+                      NMEAGPS_INVALIDATE( lat_err );
+                    #endif
+                    #ifdef GPS_FIX_LON_ERR
+                      NMEAGPS_INVALIDATE( lon_err );
+                    #endif
+                    // fall through...
+                  case 41: case 42: case 43:
+                    scratchpad.U1[ chrCount-40 ] = chr;
+                    if (chrCount == 43) {
+                      uint16_t err_cm = scratchpad.U4/100;
+
+                      #ifdef GPS_FIX_LAT_ERR
+                        m_fix.lat_err_cm = err_cm;
+                        m_fix.valid.lat_err = true;
+                      #endif
+
+                      #ifdef GPS_FIX_LON_ERR
+                        m_fix.lon_err_cm = err_cm;
+                        m_fix.valid.lon_err = true;
+                      #endif
+                    }
+                    break;
+                #endif
+
+                #ifdef GPS_FIX_ALT_ERR
+                  case 44:
+                    NMEAGPS_INVALIDATE( alt_err );
+                  case 45: case 46: case 47:
+                    scratchpad.U1[ chrCount-44 ] = chr;
+                    if (chrCount == 47) {
+                      m_fix.alt_err_cm = scratchpad.U4/100;
+                      m_fix.valid.alt_err = true;
+                    }
+                    break;
+                #endif
+
+                #ifdef GPS_FIX_SPEED
+                  case 60:
+                    NMEAGPS_INVALIDATE( speed );
+                  case 61: case 62: case 63:
+                    scratchpad.U1[ chrCount-60 ] = chr;
+                    if (chrCount == 63)
+                      setSpeed( scratchpad.U4 / 10 ); // mm/s to cm/s
+                    break;
+                #endif
+
+                #ifdef GPS_FIX_HEADING
+                  case 64:
+                    NMEAGPS_INVALIDATE( heading );
+                  case 65: case 66: case 67:
+                    scratchpad.U1[ chrCount-64 ] = chr;
+                    if (chrCount == 67)
+                      setHeading( scratchpad.U4 );
+                    break;
+                #endif
+
+                #ifdef GPS_FIX_PDOP
+                  case 76:
+                    NMEAGPS_INVALIDATE( pdop );
+                    m_fix.pdop = chr;
+                    break;
+                  case 77:
+                    m_fix.pdop |= ((uint16_t) chr) << 8;
+                    m_fix.pdop  = pdop_E3( m_fix.pdop );
+                    m_fix.valid.pdop = true;
+                    break;
+                #endif
+              }
+
+              #if defined(GPS_FIX_TIME) & defined(GPS_FIX_DATE)
+                if ((chrCount == 11) && m_fix.valid.date &&
+                    (GPSTime::start_of_week() == 0))
+                  GPSTime::start_of_week( m_fix.dateTime );
+              #endif
+            #endif
+            break;
+
           case UBX_NAV_SVINFO: //--------------------------------------
 //if (chrCount == 0) trace << F("svinfo ");
             #ifdef UBLOX_PARSE_SVINFO
@@ -747,7 +1441,13 @@ bool ubloxGPS::parseField( char c )
         break;
       case UBX_RXM: //=================================================
       case UBX_INF: //=================================================
+        break;
       case UBX_ACK: //=================================================
+        #if UBLOX_REQUEST_QUEUE_SIZE > 0
+          // The class and id of the ACKed/NAKed message
+          if (chrCount < sizeof(m_acked))
+            ((uint8_t *) &m_acked)[ chrCount ] = chr;
+        #endif
         break;
       case UBX_CFG: //=================================================
         switch (rx().msg_id) {
@@ -781,6 +1481,10 @@ bool ubloxGPS::parseField( char c )
       case UBX_TIM: //=================================================
       case UBX_NMEA: //=================================================
         break;
+      case UBX_UNK: //=================================================
+        // Not a UBX message: this is a field of an NMEA sentence.
+        ok = ubloxNMEA::parseField( c );
+        break;
       default:
         break;
     }
@@ -810,6 +1514,433 @@ bool ubloxGPS::parseFix( uint8_t c )
   return true;
 }
 
+//---------------------------------------------
+
+void ubloxGPS::setTOW( uint32_t tow_ms )
+{
+  #if defined(GPS_FIX_TIME) & defined(GPS_FIX_DATE)
+    uint16_t ms;
+    if (GPSTime::from_TOWms( tow_ms, m_fix.dateTime, ms )) {
+      m_fix.dateTime_cs = ms / 10;
+      m_fix.valid.time = true;
+      m_fix.valid.date = true;
+    } else {
+      m_fix.valid.time = false;
+      m_fix.valid.date = false;
+      m_fix.dateTime.init();
+    }
+    //trace << PSTR(".") << m_fix.dateTime_cs;
+  #endif
+}
+
+#if defined(GPS_FIX_ALTITUDE) | defined(GPS_FIX_GEOID_HEIGHT)
+  //  Convert to whole meters and hundredths.
+  static void from_mm( gps_fix::whole_frac & value, int32_t mm )
+  {
+    value.whole = mm / 1000L;
+    value.frac  = (mm - value.whole * 1000L) / 10;
+  }
+#endif
+
+#ifdef GPS_FIX_ALTITUDE
+  void ubloxGPS::setAltitude( int32_t mm )
+  {
+    from_mm( m_fix.alt, mm );
+    m_fix.valid.altitude = true;
+  }
+#endif
+
+#ifdef GPS_FIX_GEOID_HEIGHT
+  void ubloxGPS::setGeoidHeight( int32_t mm )
+  {
+    from_mm( m_fix.geoidHt, mm );
+    m_fix.valid.geoidHeight = true;
+  }
+#endif
+
+#ifdef GPS_FIX_SPEED
+  void ubloxGPS::setSpeed( uint32_t cm_per_s )
+  {
+    // Convert the 32-bit cm/s to nautical miles per hour
+    //   (actually, 1000nmi/h limit is 51444, a 16-bit cm/s)
+    // Conversion factor:
+    //     = cm/s * (3600s/1hr) * (1m/100cm) * (1nmi/1852m)
+    //     = cm/s * 36/1852
+    //     = cm/s * 0.0194384449
+    //   Fixed point math:
+    //     0.0194384449 * 2^19 = 10191.343 (14 bits)
+
+    const uint32_t FACTOR_E19 = 10191UL;
+    uint32_t nmiph_E19 = cm_per_s * FACTOR_E19;
+    m_fix.spd.whole = (nmiph_E19 >> 19);
+
+    // remove whole part, leaving fractional part
+    nmiph_E19 -= ((uint32_t)m_fix.spd.whole) << 19;
+
+    //m_fix.spd.frac = (nmiph_E19 * 1000UL) >> 19;
+    m_fix.spd.frac   = (nmiph_E19 * 125)    >> 16;
+
+    m_fix.valid.speed = true;
+  }
+#endif
+
+#ifdef GPS_FIX_HEADING
+  void ubloxGPS::setHeading( uint32_t deg_E5 )
+  {
+    m_fix.hdg.whole = deg_E5 / 100000UL;
+    deg_E5 -= ((uint32_t)m_fix.hdg.whole) * 100000UL;
+    m_fix.hdg.frac  = (deg_E5/1000UL);  // hundredths
+    m_fix.valid.heading = true;
+  }
+#endif
+
+#if defined(GPS_FIX_TIME) & defined(GPS_FIX_DATE)
+  //  NAV-PVT rounds the UTC time to the nearest second, so the
+  //  fraction can be negative.
+
+  void ubloxGPS::setFraction( int32_t ns )
+  {
+    if (ns < 0) {
+      if (m_fix.valid.date && m_fix.valid.time)
+        m_fix.dateTime = (NeoGPS::clock_t) m_fix.dateTime - 1;
+      ns += 1000000000L;
+    }
+    m_fix.dateTime_cs = ns / 10000000L;
+  }
+#endif
+
+//---------------------------------------------
+//  Copy the payload into a message structure (after its msg_t header).
+//  The message must be at least as long as the structure.
+
+static bool copy_payload( msg_t & msg, const uint8_t *payload, uint16_t length )
+{
+  if (length < msg.length)
+    return false;
+
+  memcpy( ((uint8_t *) &msg) + sizeof(msg_t), payload, msg.length );
+  return true;
+}
+
+void ubloxGPS::parsePayload( const uint8_t *payload )
+{
+  if (rx().msg_class != UBX_NAV)
+    return;
+
+  switch (rx().msg_id) {
+
+    #ifdef UBLOX_PARSE_STATUS
+      case UBX_NAV_STATUS:
+        {
+          nav_status_t msg;
+          if (copy_payload( msg, payload, rx().length ))
+            parseMsg( msg );
+        }
+        break;
+    #endif
+
+    #ifdef UBLOX_PARSE_POSLLH
+      case UBX_NAV_POSLLH:
+        {
+          nav_posllh_t msg;
+          if (copy_payload( msg, payload, rx().length ))
+            parseMsg( msg );
+        }
+        break;
+    #endif
+
+    #ifdef UBLOX_PARSE_VELNED
+      case UBX_NAV_VELNED:
+        {
+          nav_velned_t msg;
+          if (copy_payload( msg, payload, rx().length ))
+            parseMsg( msg );
+        }
+        break;
+    #endif
+
+    #ifdef UBLOX_PARSE_TIMEGPS
+      case UBX_NAV_TIMEGPS:
+        {
+          nav_timegps_t msg;
+          if (copy_payload( msg, payload, rx().length ))
+            parseMsg( msg );
+        }
+        break;
+    #endif
+
+    #ifdef UBLOX_PARSE_TIMEUTC
+      case UBX_NAV_TIMEUTC:
+        {
+          nav_timeutc_t msg;
+          if (copy_payload( msg, payload, rx().length ))
+            parseMsg( msg );
+        }
+        break;
+    #endif
+
+    #ifdef UBLOX_PARSE_PVT
+      case UBX_NAV_PVT:
+        {
+          nav_pvt_t msg;
+          if (copy_payload( msg, payload, rx().length ))
+            parseMsg( msg );
+        }
+        break;
+    #endif
+
+    #ifdef UBLOX_PARSE_SVINFO
+      case UBX_NAV_SVINFO:
+        {
+          nav_svinfo_t msg;
+          msg.init( 0 ); // just the fixed part, the channels follow
+          if (copy_payload( msg, payload, rx().length ))
+            parseMsg( msg, payload + msg.length, rx().length - msg.length );
+        }
+        break;
+    #endif
+
+    default:
+      break;
+  }
+
+} // parsePayload
+
+#ifdef UBLOX_PARSE_STATUS
+  void ubloxGPS::parseMsg( const nav_status_t & msg )
+  {
+    setTOW( msg.time_of_week );
+    parseFix( msg.status );
+    m_fix.status =
+      nav_status_t::to_status( (nav_status_t::status_t) m_fix.status, msg.flags );
+  }
+#endif
+
+#ifdef UBLOX_PARSE_POSLLH
+  void ubloxGPS::parseMsg( const nav_posllh_t & msg )
+  {
+    setTOW( msg.time_of_week );
+
+    #if defined( GPS_FIX_LOCATION ) | defined( GPS_FIX_LOCATION_DMS )
+      #ifdef GPS_FIX_LOCATION
+        m_fix.lon = msg.lon;
+        m_fix.lat = msg.lat;
+      #endif
+      #ifdef GPS_FIX_LOCATION_DMS
+        m_fix.longitudeDMS.From( msg.lon );
+        m_fix.latitudeDMS .From( msg.lat );
+      #endif
+      m_fix.valid.location = true;
+    #endif
+
+    #ifdef GPS_FIX_ALTITUDE
+      setAltitude( msg.height_MSL );
+    #endif
+
+    #if defined( GPS_FIX_LAT_ERR ) | defined( GPS_FIX_LON_ERR )
+      uint16_t err_cm = msg.horiz_acc/100;
+
+      #ifdef GPS_FIX_LAT_ERR
+        m_fix.lat_err_cm = err_cm;
+        m_fix.valid.lat_err = true;
+      #endif
+
+      #ifdef GPS_FIX_LON_ERR
+        m_fix.lon_err_cm = err_cm;
+        m_fix.valid.lon_err = true;
+      #endif
+    #endif
+
+    #ifdef GPS_FIX_ALT_ERR
+      m_fix.alt_err_cm = msg.vert_acc/100;
+      m_fix.valid.alt_err = true;
+    #endif
+  }
+#endif
+
+#ifdef UBLOX_PARSE_VELNED
+  void ubloxGPS::parseMsg( const nav_velned_t & msg )
+  {
+    setTOW( msg.time_of_week );
+
+    #ifdef GPS_FIX_SPEED
+      setSpeed( msg.speed_2D );
+    #endif
+
+    #ifdef GPS_FIX_HEADING
+      setHeading( msg.heading );
+    #endif
+  }
+#endif
+
+#ifdef UBLOX_PARSE_TIMEGPS
+  void ubloxGPS::parseMsg( const nav_timegps_t & msg )
+  {
+    #if defined(GPS_FIX_TIME) & defined(GPS_FIX_DATE)
+      setTOW( msg.time_of_week );
+
+      GPSTime::leap_seconds = msg.leap_seconds;
+      if (!msg.valid.leap_seconds)
+        GPSTime::leap_seconds = 0; // use the built-in table
+      if (msg.valid.week)
+        GPSTime::start_of_week( msg.week );
+      if (!msg.valid.time_of_week) {
+        m_fix.valid.date =
+        m_fix.valid.time = false;
+      }
+    #endif
+  }
+#endif
+
+#ifdef UBLOX_PARSE_TIMEUTC
+  void ubloxGPS::parseMsg( const nav_timeutc_t & msg )
+  {
+    #if defined(GPS_FIX_TIME) | defined(GPS_FIX_DATE)
+      bool ok = (msg.valid.UTC & msg.valid.time_of_week);
+
+      #if defined(GPS_FIX_DATE)
+        m_fix.dateTime.year  = msg.year % 100;
+        m_fix.dateTime.month = msg.month;
+        m_fix.dateTime.date  = msg.day;
+        m_fix.valid.date     = ok;
+      #endif
+
+      #if defined(GPS_FIX_TIME)
+        m_fix.dateTime.hours   = msg.hour;
+        m_fix.dateTime.minutes = msg.minute;
+        m_fix.dateTime.seconds = msg.second;
+        m_fix.valid.time       = ok;
+      #endif
+
+      #if defined(GPS_FIX_TIME) & defined(GPS_FIX_DATE)
+        if (m_fix.valid.date &&
+            (GPSTime::start_of_week() == 0))
+          GPSTime::start_of_week( m_fix.dateTime );
+      #endif
+    #endif
+  }
+#endif
+
+#ifdef UBLOX_PARSE_SVINFO
+  void ubloxGPS::parseMsg
+    ( const nav_svinfo_t & msg, const uint8_t *sv, uint16_t length )
+  {
+    setTOW( msg.time_of_week );
+
+    #ifdef GPS_FIX_SATELLITES
+      m_fix.satellites = msg.num_channels;
+      m_fix.valid.satellites = true;
+
+      #ifdef NMEAGPS_PARSE_SATELLITES
+        sat_count = 0;
+        while ((length >= sizeof(nav_svinfo_t::sv_t)) &&
+               (sat_count < NMEAGPS_MAX_SATELLITES)) {
+          nav_svinfo_t::sv_t info;
+          memcpy( &info, sv, sizeof(info) );
+          sv     += sizeof(info);
+          length -= sizeof(info);
+
+          satellites[sat_count].id        = info.id;
+          #ifdef NMEAGPS_PARSE_SATELLITE_INFO
+            satellites[sat_count].tracked   = (info.channel != 255);
+            satellites[sat_count].snr       = info.snr;
+            satellites[sat_count].elevation = info.elevation;
+            satellites[sat_count].azimuth   = info.azimuth;
+          #endif
+          sat_count++;
+        }
+      #endif
+    #endif
+  }
+#endif
+
+#ifdef UBLOX_PARSE_PVT
+  void ubloxGPS::parseMsg( const nav_pvt_t & msg )
+  {
+    #if defined(GPS_FIX_DATE)
+      m_fix.dateTime.year  = msg.year % 100;
+      m_fix.dateTime.month = msg.month;
+      m_fix.dateTime.date  = msg.day;
+      m_fix.valid.date     = msg.valid.date;
+    #endif
+
+    #if defined(GPS_FIX_TIME)
+      m_fix.dateTime.hours   = msg.hour;
+      m_fix.dateTime.minutes = msg.minute;
+      m_fix.dateTime.seconds = msg.second;
+      m_fix.valid.time       = msg.valid.time;
+    #endif
+
+    #if defined(GPS_FIX_TIME) & defined(GPS_FIX_DATE)
+      if (m_fix.valid.date &&
+          (GPSTime::start_of_week() == 0))
+        GPSTime::start_of_week( m_fix.dateTime );
+      setFraction( msg.nanoseconds );
+    #endif
+
+    parseFix( msg.fix_type );
+    m_fix.status =
+      nav_status_t::to_status
+        ( (nav_status_t::status_t) m_fix.status,
+          *((const nav_status_t::flags_t *) &msg.flags) );
+
+    #ifdef GPS_FIX_SATELLITES
+      m_fix.satellites = msg.num_sv;
+      m_fix.valid.satellites = true;
+    #endif
+
+    #if defined( GPS_FIX_LOCATION ) | defined( GPS_FIX_LOCATION_DMS )
+      #ifdef GPS_FIX_LOCATION
+        m_fix.lon = msg.lon;
+        m_fix.lat = msg.lat;
+      #endif
+      #ifdef GPS_FIX_LOCATION_DMS
+        m_fix.longitudeDMS.From( msg.lon );
+        m_fix.latitudeDMS .From( msg.lat );
+      #endif
+      m_fix.valid.location = true;
+    #endif
+
+    #ifdef GPS_FIX_GEOID_HEIGHT
+      setGeoidHeight( msg.height_above_ellipsoid - msg.height_MSL );
+    #endif
+    #ifdef GPS_FIX_ALTITUDE
+      setAltitude( msg.height_MSL );
+    #endif
+
+    #if defined( GPS_FIX_LAT_ERR ) | defined( GPS_FIX_LON_ERR )
+      uint16_t err_cm = msg.horiz_acc/100;
+
+      #ifdef GPS_FIX_LAT_ERR
+        m_fix.lat_err_cm = err_cm;
+        m_fix.valid.lat_err = true;
+      #endif
+
+      #ifdef GPS_FIX_LON_ERR
+        m_fix.lon_err_cm = err_cm;
+        m_fix.valid.lon_err = true;
+      #endif
+    #endif
+
+    #ifdef GPS_FIX_ALT_ERR
+      m_fix.alt_err_cm = msg.vert_acc/100;
+      m_fix.valid.alt_err = true;
+    #endif
+
+    #ifdef GPS_FIX_SPEED
+      setSpeed( (uint32_t) msg.ground_speed / 10 ); // mm/s to cm/s
+    #endif
+    #ifdef GPS_FIX_HEADING
+      setHeading( msg.heading_motion );
+    #endif
+
+    #ifdef GPS_FIX_PDOP
+      m_fix.pdop = pdop_E3( msg.pdop );
+      m_fix.valid.pdop = true;
+    #endif
+  }
+#endif
+
 #if 0
   static const uint8_t cfg_msg_data[] __PROGMEM =
     { ubloxGPS::UBX_CFG, ubloxGPS::UBX_CFG_MSG,
@@ -42,9 +42,59 @@
 #define UBLOX_PARSE_POSLLH
 #define UBLOX_PARSE_VELNED
 #define UBLOX_PARSE_SVINFO
+//#define UBLOX_PARSE_PVT
 //#define UBLOX_PARSE_CFGNAV5
 //#define UBLOX_PARSE_MONVER
 
+/**
+ * Capture the RXM_RAWX and RXM_SFRBX messages in member /raw/ (see
+ * ubxRaw.h).  This uses a lot of RAM.
+ */
+
+//#define UBLOX_PARSE_RAW
+
+#ifdef UBLOX_PARSE_RAW
+  #include "ubxRaw.h"
+
+  //  RXM_RAWX can have up to 255 measurements.  Longer epochs are
+  //  received, but only UBLOX_RAW_MAX_MEAS are kept.
+  #define UBLOX_MAX_LENGTH (16 + 32*255)
+#else
+  //  Longer frames are discarded.
+  #define UBLOX_MAX_LENGTH 512
+#endif
+
+/**
+ * Non-blocking requests (see /queue_request/).  This is the number of
+ * CFG messages and polls that can be waiting for an ACK or reply at the
+ * same time.  Each one uses 9 bytes of RAM on AVRs.  Leave it commented
+ * out if only the blocking /send/ and /poll/ methods are used.
+ */
+
+//#define UBLOX_REQUEST_QUEUE_SIZE 4
+
+#ifndef UBLOX_REQUEST_QUEUE_SIZE
+  #define UBLOX_REQUEST_QUEUE_SIZE 0
+#endif
+
+//  The default time to wait for an ACK or reply, in milliseconds.
+#ifndef UBLOX_REQUEST_TIMEOUT
+  #define UBLOX_REQUEST_TIMEOUT 1000
+#endif
+
+/**
+ * Registered message storage (see /store/).  This is the number of
+ * message types whose payloads can be saved without overriding
+ * /storage_for/.  Each one uses 13 bytes of RAM on AVRs.  Leave it
+ * commented out if /storage_for/ is overridden instead.
+ */
+
+//#define UBLOX_STORAGE_TABLE_SIZE 2
+
+#ifndef UBLOX_STORAGE_TABLE_SIZE
+  #define UBLOX_STORAGE_TABLE_SIZE 0
+#endif
+
 
 class ubloxGPS : public ubloxNMEA
 {
@@ -59,8 +109,20 @@ public:
         reply( (ublox::msg_t *) NULL ),
         reply_expected( false ),
         ack_expected( false ),
+        safe( true ),
         m_device( device )
-      {};
+      {
+        #if UBLOX_REQUEST_QUEUE_SIZE > 0
+          for (uint8_t i=0; i < UBLOX_REQUEST_QUEUE_SIZE; i++)
+            m_requests[i].pending = false;
+          m_request_failures = 0;
+        #endif
+        #if UBLOX_STORAGE_TABLE_SIZE > 0
+          m_stored_count = 0;
+          m_stored_rx    = UBLOX_STORAGE_TABLE_SIZE;
+          m_stored_drops = 0;
+        #endif
+      };
 
     /**
      * Process one character of ublox message.  The internal state 
@@ -71,6 +133,44 @@ public:
      */
     decode_t decode( char c );
 
+    /**
+     * Process one complete UBX frame from a buffer: the sync characters,
+     * class, id, length, payload and checksum.  The length and checksum
+     * are validated over the whole frame before anything is changed, and
+     * the payload is copied into the ublox::nav_*_t structure for its
+     * message type.  The /fix/ members are then set from whole words.
+     * This is much faster than /decode/ when complete frames are already
+     * in memory (e.g., from a DMA buffer or a log file).  It must not be
+     * used while /decode/ is in the middle of a UBX message.
+     * @param[in]  frame points to the first sync character.
+     * @param[in]  len   number of bytes available at /frame/.
+     * @param[out] used  number of bytes that were consumed.  This is 0
+     *                   if /len/ does not hold the whole frame yet, and
+     *                   1 if the frame is invalid, so that the caller
+     *                   can look for the next sync character.
+     * @return DECODE_COMPLETED when a valid frame was processed,
+     *         DECODE_CHR_OK when more bytes are needed, or
+     *         DECODE_CHR_INVALID if the frame is invalid.
+     */
+    decode_t decode_frame( const uint8_t *frame, uint16_t len, uint16_t & used );
+
+    /**
+     * Process the next part of a buffer with both NMEA and UBX messages:
+     * one complete UBX frame (see /decode_frame/), the NMEA characters
+     * up to the end of a sentence or the end of the buffer, or the
+     * characters before the next '$' or UBX sync character.  Call it
+     * until the buffer is used up.  This is much faster than passing
+     * each character to /decode/, which must check both protocols.  It
+     * must not be used while /decode/ is in the middle of a UBX message.
+     * @param[out] used  number of bytes that were consumed.  This is 0
+     *                   if /len/ does not hold the whole UBX frame yet;
+     *                   keep those bytes and call again with more.
+     * @return DECODE_COMPLETED when a sentence or frame was completed,
+     *         DECODE_CHR_OK when more bytes are needed, or
+     *         DECODE_CHR_INVALID if bytes were skipped.
+     */
+    decode_t demux( const uint8_t *buf, uint16_t len, uint16_t & used );
+
     /**
      * Received message header.  Payload is only stored if /storage/ is 
      * overridden for that message type.
@@ -116,6 +216,14 @@ public:
     bool send( const ublox::msg_t & msg, ublox::msg_t *reply_msg = (ublox::msg_t *) NULL );
     bool send_P( const ublox::msg_t & msg, ublox::msg_t *reply_msg = (ublox::msg_t *) NULL );
 
+    /**
+     * Send a complete frame from PROGMEM (blocking), like /send/.  The
+     * frame already has its sync characters and checksum, usually from
+     * a ublox::frame_P built at compile time (see ubxmsg.h), so it is
+     * written as is.
+     */
+    bool send_frame_P( const uint8_t *frame_P, ublox::msg_t *reply_msg = (ublox::msg_t *) NULL );
+
     //  Ask for a specific message (non-blocking).
     //     /on_event/ will receive the header later.
     //  See also /send_request/.
@@ -146,6 +254,102 @@ public:
       return send( poll_msg, reply_msg );
     };
 
+    #if UBLOX_REQUEST_QUEUE_SIZE > 0
+
+      /**
+       * Send a message and return immediately, without waiting for
+       * the reply.  Several requests can be outstanding at once.
+       *    If /msg/ is a UBX_CFG, the matching UBX_CFG_ACK/NAK completes
+       *      the request.
+       *    If /reply_msg/ is given, the reply with the same class and id
+       *      is stored there.  It does not generate an event.
+       *    Each request times out separately, after /timeout_ms/.
+       * When a request is completed, /request_done/ is called.  Replies
+       * and ACKs are matched while characters are decoded, so the
+       * configuration overlaps with normal fix processing.
+       * @return false if the queue is full.  Nothing was sent, so try
+       *   again after a request has been completed.
+       */
+      bool queue_request
+        ( const ublox::msg_t & msg,
+          ublox::msg_t *reply_msg = (ublox::msg_t *) NULL,
+          uint16_t timeout_ms = UBLOX_REQUEST_TIMEOUT );
+      bool queue_request_P
+        ( const ublox::msg_t & msg,
+          ublox::msg_t *reply_msg = (ublox::msg_t *) NULL,
+          uint16_t timeout_ms = UBLOX_REQUEST_TIMEOUT );
+      //  A complete frame from PROGMEM (see /send_frame_P/).
+      bool queue_frame_P
+        ( const uint8_t *frame_P,
+          ublox::msg_t *reply_msg = (ublox::msg_t *) NULL,
+          uint16_t timeout_ms = UBLOX_REQUEST_TIMEOUT );
+
+      /**
+       * Complete any requests that have timed out.  Call this regularly
+       * (e.g., from loop) while requests are pending.
+       */
+      void check_requests();
+
+      uint8_t requests_pending() const;
+
+      //  Number of requests that were NAKed or timed out.
+      uint16_t request_failures() const { return m_request_failures; }
+
+      enum request_result_t {
+          REQUEST_OK,      // ACKed and/or replied
+          REQUEST_NAK,
+          REQUEST_TIMEOUT
+        };
+
+    #endif
+
+    #if UBLOX_STORAGE_TABLE_SIZE > 0
+
+      /**
+       * Save the payload of every received message with the same class
+       * and id as /msg/ in /msg/.  /msg.length/ is the most that will be
+       * saved.  Stored types are not passed to /storage_for/, so a
+       * derived class is not needed.
+       *    With one buffer, a message is dropped if it arrives while the
+       *      buffer is locked (see /lock_stored/).
+       *    With two buffers, each message is received into the buffer
+       *      that is not locked, so the last complete copy can always be
+       *      read while the next one is arriving.  /msg2/ must have the
+       *      same class, id and length.
+       * Call this before decoding starts (e.g., in setup).
+       * @return false if the table is full or the type is already stored.
+       */
+      bool store( ublox::msg_t & msg );
+      bool store( ublox::msg_t & msg, ublox::msg_t & msg2 );
+
+      /**
+       * Lock the last complete copy of a stored message type.  It will
+       * not be changed until /unlock_stored/ is called, even if /decode/
+       * runs in an ISR.  Interrupts do not need to be disabled.
+       * @return the copy, or NULL if there is none (yet).
+       */
+      const ublox::msg_t *lock_stored
+        ( ublox::msg_class_t msg_class, ublox::msg_id_t msg_id );
+      void unlock_stored( ublox::msg_class_t msg_class, ublox::msg_id_t msg_id );
+
+      //  True if a new copy has been completed since the last /lock_stored/.
+      bool stored_available
+        ( ublox::msg_class_t msg_class, ublox::msg_id_t msg_id ) const;
+
+      //  Number of messages dropped because their only buffer was locked.
+      uint16_t stored_drops() const { return m_stored_drops; }
+
+    #endif
+
+    #ifdef UBLOX_PARSE_RAW
+      /**
+       * The captured raw measurement epochs and subframes.  Process
+       * them in loop with epoch_available/epoch/epoch_done, or write
+       * them to a log with a ubloxRawWriter.
+       */
+      ublox::raw_queue_t raw;
+    #endif
+
     //  Return the Stream that was passed into the constructor.
     Stream *Device() const { return (Stream *)m_device; };
 
@@ -170,17 +374,12 @@ protected:
     static const ubxState_t UBX_FIRST_STATE = UBX_SYNC2;
     static const ubxState_t UBX_LAST_STATE  = UBX_CRC_B;
 
-    inline void write
-      ( uint8_t c, uint8_t & crc_a, uint8_t & crc_b ) const
-    {
-        m_device->print( (char) c );
-        crc_a += c;
-        crc_b += crc_a;
-    };
     void write( const ublox::msg_t & msg );
     void write_P( const ublox::msg_t & msg );
+    void write_frame_P( const uint8_t *frame_P );
 
     void wait_for_idle();
+    bool wait_for_reply( ublox::msg_t *reply_msg );
     bool wait_for_ack();
     bool waiting() const
     {
@@ -214,6 +413,15 @@ protected:
     virtual ublox::msg_t *storage_for( const ublox::msg_t & rx_msg )
       { return (ublox::msg_t *)NULL; };
 
+    #if UBLOX_REQUEST_QUEUE_SIZE > 0
+      // Override this to find out when a /queue_request/ is completed.
+      // This may execute in an interrupt context, so be quick!
+      virtual void request_done
+        ( const ublox::msg_hdr_t & msg, ublox::msg_t *reply_msg,
+          request_result_t result )
+        {};
+    #endif
+
 private:
     ublox::msg_t   *storage;   // cached ptr to hold a received msg.
 
@@ -229,9 +437,60 @@ private:
       bool     ack_received NEOGPS_BF(1);
       bool     nak_received NEOGPS_BF(1);
       bool     ack_same_as_sent NEOGPS_BF(1);
+      bool     safe NEOGPS_BF(1); // m_fix is not being changed by a UBX msg
     } NEOGPS_PACKED;
     struct ublox::msg_hdr_t sent;
 
+    #if UBLOX_REQUEST_QUEUE_SIZE > 0
+      struct request_t {
+        ublox::msg_hdr_t  msg;        // the request's class and id
+        ublox::msg_t     *reply;      // storage for the reply, or NULL
+        uint16_t          sent_ms;    // low 16 bits of millis()
+        uint16_t          timeout_ms;
+        bool              pending        NEOGPS_BF(1);
+        bool              ack_expected   NEOGPS_BF(1);
+        bool              reply_expected NEOGPS_BF(1);
+      } NEOGPS_PACKED;
+
+      request_t        m_requests[ UBLOX_REQUEST_QUEUE_SIZE ];
+      uint16_t         m_request_failures;
+      ublox::msg_hdr_t m_acked;   // from the ACK/NAK payload
+
+      bool    add_request( ublox::msg_hdr_t msg, ublox::msg_t *reply_msg,
+                           uint16_t timeout_ms );
+      uint8_t oldest_request( const ublox::msg_hdr_t & msg, bool ack );
+      void    ack_request( bool acked );
+      void    request_complete( uint8_t i, request_result_t result );
+    #endif
+
+    #if UBLOX_STORAGE_TABLE_SIZE > 0
+      static const uint8_t NO_BUFFER = 0xFF;
+
+      //  /ready/, /updates/ and the buffers are only changed by /decode/,
+      //  and /reading/ and /seen/ are only changed by the application.
+      //  Each single-byte member has one writer, so no locks are needed.
+      struct stored_t {
+        ublox::msg_hdr_t  msg;
+        uint16_t          length;      // of each buffer
+        ublox::msg_t     *buffer[2];   // [1] is NULL if single-buffered
+        volatile uint8_t  ready;       // buffer with the last complete copy
+        volatile uint8_t  reading;     // buffer locked by the application
+        volatile uint8_t  updates;     // count of completed copies
+        uint8_t           seen;        // /updates/ at the last lock
+        uint8_t           writing;     // buffer being received
+      } NEOGPS_PACKED;
+
+      stored_t m_stored[ UBLOX_STORAGE_TABLE_SIZE ];
+      uint8_t  m_stored_count;
+      uint8_t  m_stored_rx;    // entry being received
+      uint16_t m_stored_drops;
+
+      uint8_t       find_stored( const ublox::msg_hdr_t & msg ) const;
+      bool          add_stored( ublox::msg_t & msg, ublox::msg_t *msg2 );
+      ublox::msg_t *stored_storage( uint8_t i );
+      void          stored_commit();
+    #endif
+
     struct rx_msg_t : ublox::msg_t
     {
       uint8_t  crc_a;   // accumulated as packet received
@@ -256,13 +515,16 @@ private:
     rx_msg_t m_rx_msg;
 
     void rxBegin();
+    void rxStorage();
     bool rxEnd();
 
-    static const uint8_t SYNC_1 = 0xB5;
-    static const uint8_t SYNC_2 = 0x62;
-
     Stream *m_device;
 
+    #if defined(UBLOX_PARSE_TIMEGPS) & \
+        defined(GPS_FIX_TIME) & defined(GPS_FIX_DATE)
+      uint16_t m_week; // from NAV-TIMEGPS, until its valid flags arrive
+    #endif
+
     bool parseFix( uint8_t c );
 
     bool parseTOW( uint8_t chr )
@@ -278,21 +540,57 @@ private:
         if (chrCount == 3) {
           uint32_t tow = *((uint32_t *) &m_fix.dateTime);
           //trace << PSTR("@ ") << tow;
-
-          uint16_t ms;
-          if (GPSTime::from_TOWms( tow, m_fix.dateTime, ms )) {
-            m_fix.dateTime_cs = ms / 10;
-            m_fix.valid.time = true;
-            m_fix.valid.date = true;
-          } else
-            m_fix.dateTime.init();
-          //trace << PSTR(".") << m_fix.dateTime_cs;
+          setTOW( tow );
         }
       #endif
 
       return true;
     }
 
+    //  Conversions from the UBX units, shared by /parseField/ (when the
+    //  last byte of a field arrives) and /decode_frame/.
+    void setTOW( uint32_t tow_ms );
+    #ifdef GPS_FIX_ALTITUDE
+      void setAltitude( int32_t mm );
+    #endif
+    #ifdef GPS_FIX_GEOID_HEIGHT
+      void setGeoidHeight( int32_t mm );
+    #endif
+    #ifdef GPS_FIX_SPEED
+      void setSpeed( uint32_t cm_per_s );
+    #endif
+    #ifdef GPS_FIX_HEADING
+      void setHeading( uint32_t deg_E5 );
+    #endif
+    #if defined(GPS_FIX_TIME) & defined(GPS_FIX_DATE)
+      void setFraction( int32_t ns );
+    #endif
+
+    //  Set the /fix/ members from a complete message (see /decode_frame/).
+    #ifdef UBLOX_PARSE_STATUS
+      void parseMsg( const ublox::nav_status_t & msg );
+    #endif
+    #ifdef UBLOX_PARSE_POSLLH
+      void parseMsg( const ublox::nav_posllh_t & msg );
+    #endif
+    #ifdef UBLOX_PARSE_VELNED
+      void parseMsg( const ublox::nav_velned_t & msg );
+    #endif
+    #ifdef UBLOX_PARSE_TIMEGPS
+      void parseMsg( const ublox::nav_timegps_t & msg );
+    #endif
+    #ifdef UBLOX_PARSE_TIMEUTC
+      void parseMsg( const ublox::nav_timeutc_t & msg );
+    #endif
+    #ifdef UBLOX_PARSE_SVINFO
+      void parseMsg( const ublox::nav_svinfo_t & msg, const uint8_t *sv,
+                     uint16_t length );
+    #endif
+    #ifdef UBLOX_PARSE_PVT
+      void parseMsg( const ublox::nav_pvt_t & msg );
+    #endif
+    void parsePayload( const uint8_t *payload );
+
 } NEOGPS_PACKED;
 
 #endif
@@ -0,0 +1,239 @@
+/**
+ * @file ubxLog.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "ubxLog.h"
+
+using namespace ublox;
+
+static const uint32_t MS_PER_WEEK = GPSTime::SECONDS_PER_WEEK * 1000UL;
+
+//------------------------------------------------------------------
+//  The time of week in a frame's payload, if it has one.
+
+static bool frame_tow( const uint8_t *frame, uint16_t length, uint32_t & tow_ms )
+{
+  const uint8_t *payload = &frame[6];
+
+  if (frame[2] == UBX_NAV) {
+    //  Most NAV messages start with the time of week in ms, but some
+    //  have a version and reserved bytes first.  Messages that are not
+    //  listed here are not timed.
+    uint8_t offset;
+    switch (frame[3]) {
+      case 0x01: // POSECEF
+      case UBX_NAV_POSLLH:
+      case UBX_NAV_STATUS:
+      case 0x04: // DOP
+      case 0x05: // ATT
+      case 0x06: // SOL
+      case UBX_NAV_PVT:
+      case 0x11: // VELECEF
+      case UBX_NAV_VELNED:
+      case UBX_NAV_TIMEGPS:
+      case UBX_NAV_TIMEUTC:
+      case 0x22: // CLOCK
+      case 0x23: // TIMEGLO
+      case 0x24: // TIMEBDS
+      case 0x25: // TIMEGAL
+      case 0x26: // TIMELS
+      case UBX_NAV_SVINFO:
+      case 0x31: // DGPS
+      case 0x32: // SBAS
+      case 0x34: // ORB
+      case 0x35: // SAT
+      case 0x39: // GEOFENCE
+      case 0x43: // SIG
+      case 0x61: // EOE
+        offset = 0;
+        break;
+
+      case 0x09: // ODO
+      case 0x13: // HPPOSECEF
+      case 0x14: // HPPOSLLH
+      case 0x3B: // SVIN
+      case 0x3C: // RELPOSNED
+        offset = 4;
+        break;
+
+      default:
+        return false;
+    }
+
+    if (length < offset + 4)
+      return false;
+
+    payload += offset;
+    tow_ms   = payload[0] | ((uint32_t) payload[1] <<  8) |
+               ((uint32_t) payload[2] << 16) | ((uint32_t) payload[3] << 24);
+    return (tow_ms < MS_PER_WEEK);
+  }
+
+  #if __SIZEOF_DOUBLE__ == 8
+    if ((frame[2] == UBX_RXM) && (frame[3] == UBX_RXM_RAWX) && (length >= 8)) {
+      uint64_t r8;
+      memcpy( &r8, payload, sizeof(r8) );
+      double s = r8_to_double( r8 );
+      if ((s >= 0.0) && (s < GPSTime::SECONDS_PER_WEEK)) {
+        tow_ms = (uint32_t) (s * 1000.0 + 0.5);
+        return true;
+      }
+    }
+  #endif
+
+  return false;
+
+} // frame_tow
+
+//------------------------------------------------------------------
+
+uint32_t ubloxLogIndex::build( const uint8_t *log, uint32_t len )
+{
+  m_log     = log;
+  m_len     = len;
+  m_count   = 0;
+  skipped   = 0;
+  truncated = false;
+
+  uint32_t weeks   = 0;
+  uint32_t last_ms = 0;
+  bool     timed   = false;
+  uint32_t i       = 0;
+
+  while (i < len) {
+
+    if ((log[i] != SYNC_1) || (len - i < 8) || (log[i+1] != SYNC_2)) {
+      skipped++;
+      i++;
+      continue;
+    }
+
+    const uint8_t *frame  = &log[i];
+    uint16_t       length = frame[4] | ((uint16_t) frame[5] << 8);
+    if ((length > UBLOX_MAX_LENGTH) || (len - i < length + 8UL)) {
+      skipped++;
+      i++;
+      continue;
+    }
+
+    uint8_t crc_a = 0;
+    uint8_t crc_b = 0;
+    fletcher8( &frame[2], length + 4, crc_a, crc_b );
+    if ((frame[ length+6 ] != crc_a) || (frame[ length+7 ] != crc_b)) {
+      skipped++;
+      i++;
+      continue;
+    }
+
+    if (m_count == m_max) {
+      truncated = true;
+      break;
+    }
+
+    //  Keep the times increasing.  A big step back is a week rollover,
+    //  and a small one is a late message from the previous epoch.
+    uint32_t tow;
+    if (frame_tow( frame, length, tow )) {
+      uint32_t t = weeks * MS_PER_WEEK + tow;
+      if (timed && (t < last_ms)) {
+        if (last_ms - t > MS_PER_WEEK/2) {
+          weeks++;
+          t += MS_PER_WEEK;
+        } else
+          t = last_ms;
+      }
+      last_ms = t;
+      timed   = true;
+    }
+
+    entry_t & e     = m_entries[ m_count++ ];
+    e.offset        = i;
+    e.time_ms       = last_ms;
+    e.msg.msg_class = (msg_class_t) frame[2];
+    e.msg.msg_id    = (msg_id_t)    frame[3];
+
+    i += length + 8;
+  }
+
+  return m_count;
+
+} // build
+
+//------------------------------------------------------------------
+
+uint32_t ubloxLogIndex::lower_bound( uint32_t time_ms ) const
+{
+  uint32_t lo = 0;
+  uint32_t hi = m_count;
+
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (m_entries[ mid ].time_ms < time_ms)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+uint32_t ubloxLogIndex::seek( uint32_t tow_ms ) const
+{
+  if (m_count == 0)
+    return 0;
+
+  //  Before the first time?  Then it is in a later week.
+  uint32_t first = m_entries[0].time_ms;
+  while (tow_ms < first) {
+    if (tow_ms > 0xFFFFFFFFUL - MS_PER_WEEK)
+      return m_count;
+    tow_ms += MS_PER_WEEK;
+  }
+
+  return lower_bound( tow_ms );
+}
+
+uint32_t ubloxLogIndex::seek
+  ( uint32_t tow_ms, msg_class_t msg_class, msg_id_t msg_id ) const
+{
+  msg_hdr_t msg;
+  msg.msg_class = msg_class;
+  msg.msg_id    = msg_id;
+
+  for (uint32_t i = seek( tow_ms ); i < m_count; i++)
+    if (m_entries[i].msg.same_kind( msg ))
+      return i;
+
+  return m_count;
+}
+
+//------------------------------------------------------------------
+
+uint32_t ubloxLogIndex::decode_epoch( ubloxGPS & gps, uint32_t i ) const
+{
+  if (i >= m_count)
+    return m_count;
+
+  uint32_t epoch = m_entries[i].time_ms;
+
+  for (; (i < m_count) && (m_entries[i].time_ms == epoch); i++) {
+    uint16_t used;
+    gps.decode_frame( frame( i ), frame_length( i ), used );
+  }
+
+  return i;
+}
@@ -0,0 +1,108 @@
+#ifndef UBXLOG_H
+#define UBXLOG_H
+
+/**
+ * @file ubxLog.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "ubxGPS.h"
+
+//------------------------------------------------------------------
+//  An index of the UBX frames in a binary log, for random access by
+//  GPS time of week.
+//
+//  The log must be in memory: on a host, mmap the file; on an MCU,
+//  use a memory-mapped flash partition or external RAM.  One pass over
+//  the log validates each frame and records its offset, class, id and
+//  time in an array of entries provided by the caller.  Seeking is then
+//  a binary search, and only the frames of the requested epoch are
+//  decoded.
+//
+//  The time of a frame is the time_of_week (iTOW) of NAV messages, or
+//  the receiver time of RXM_RAWX (where a double has 64 bits).  Other
+//  frames belong to the epoch of the previous timed frame.  The index
+//  times keep increasing across a week rollover, so a log can span the
+//  end of the GPS week (up to 7 weeks in total).  Non-UBX data (e.g.,
+//  NMEA) and invalid frames are skipped.
+
+class ubloxLogIndex
+{
+public:
+
+  struct entry_t {
+    uint32_t         offset;   // of the first sync character
+    uint32_t         time_ms;  // time of week, plus any rollovers
+    ublox::msg_hdr_t msg;
+  }  __attribute__((packed));
+
+  ubloxLogIndex( entry_t *entries, uint32_t max_entries )
+    : skipped( 0 ), truncated( false ),
+      m_entries( entries ), m_max( max_entries ),
+      m_log( (const uint8_t *) NULL ), m_len( 0 ), m_count( 0 )
+    {}
+
+  /**
+   * Index the frames of /log/.  If the entries array fills up, the rest
+   * of the log is not indexed and /truncated/ is set.
+   * @return the number of entries.
+   */
+  uint32_t build( const uint8_t *log, uint32_t len );
+
+  uint32_t        count() const { return m_count; }
+  const entry_t & operator []( uint32_t i ) const { return m_entries[i]; }
+
+  //  A frame from the log, and its total length (header and checksum).
+  const uint8_t *frame( uint32_t i ) const
+    { return &m_log[ m_entries[i].offset ]; }
+  uint16_t frame_length( uint32_t i ) const
+    {
+      const uint8_t *f = frame( i );
+      return (f[4] | ((uint16_t) f[5] << 8)) + 8;
+    }
+
+  /**
+   * Find the first frame at or after /tow_ms/, optionally with a
+   * specific class and id.  A time of week before the first indexed
+   * time is taken to be in the following week.
+   * @return the entry index, or /count/ if there is none.
+   */
+  uint32_t seek( uint32_t tow_ms ) const;
+  uint32_t seek( uint32_t tow_ms,
+                 ublox::msg_class_t msg_class, ublox::msg_id_t msg_id ) const;
+
+  /**
+   * Decode all frames of the epoch that contains entry /i/, starting
+   * from /i/, with /ubloxGPS::decode_frame/.
+   * @return the index of the first entry of the next epoch.
+   */
+  uint32_t decode_epoch( ubloxGPS & gps, uint32_t i ) const;
+
+  uint32_t skipped;    // bytes that were not part of a valid frame
+  bool     truncated;  // the entries array was too small
+
+protected:
+  entry_t       *m_entries;
+  uint32_t       m_max;
+  const uint8_t *m_log;
+  uint32_t       m_len;
+  uint32_t       m_count;
+
+  //  The first entry with a time not less than /time_ms/.
+  uint32_t lower_bound( uint32_t time_ms ) const;
+};
+
+#endif
@@ -0,0 +1,106 @@
+/**
+ * @file ubxRaw.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "ubxGPS.h"
+
+#ifdef UBLOX_PARSE_RAW
+
+using namespace ublox;
+
+//------------------------------------------------------------------
+
+msg_t *raw_queue_t::storage_for( const msg_hdr_t & rx )
+{
+  if (rx.msg_class == UBX_RXM) {
+    if (rx.msg_id == UBX_RXM_RAWX)
+      return epochs.receive();
+    if (rx.msg_id == UBX_RXM_SFRBX)
+      return subframes.receive();
+  }
+
+  return (msg_t *) NULL;
+}
+
+//------------------------------------------------------------------
+//  The slot length has already been reduced to the received length.
+//  Only the measurements that fit are kept.
+
+bool raw_queue_t::commit( msg_t *msg )
+{
+  if (epochs.receiving( msg )) {
+    raw_epoch_t *epoch = (raw_epoch_t *) msg;
+    uint16_t     fit   = 0;
+    if (epoch->length > UBX_MSG_LEN(rxm_rawx_t))
+      fit = (epoch->length - UBX_MSG_LEN(rxm_rawx_t)) / sizeof(epoch->meas[0]);
+    if (epoch->num_meas > fit) {
+      meas_dropped   += epoch->num_meas - fit;
+      epoch->num_meas = fit;
+    }
+    epoch->length = UBX_MSG_LEN(rxm_rawx_t) +
+                    epoch->num_meas * sizeof(epoch->meas[0]);
+
+    epochs.commit();
+    return true;
+  }
+
+  if (subframes.receiving( msg )) {
+    rxm_sfrbx_t *sfrbx = (rxm_sfrbx_t *) msg;
+    uint8_t      fit   = 0;
+    if (sfrbx->length > UBX_MSG_LEN(rxm_sfrbx_t) - sizeof(sfrbx->words))
+      fit = (sfrbx->length - (UBX_MSG_LEN(rxm_sfrbx_t) - sizeof(sfrbx->words)))
+              / sizeof(sfrbx->words[0]);
+    if (sfrbx->num_words > fit)
+      sfrbx->num_words = fit;
+
+    subframes.commit();
+    return true;
+  }
+
+  return false;
+
+} // commit
+
+//------------------------------------------------------------------
+
+void ubloxRawWriter::write( const raw_epoch_t & epoch )
+{
+  write_frame( m_outs, (const uint8_t *) &epoch,
+               sizeof(msg_t) + epoch.length, false );
+  epochs++;
+}
+
+void ubloxRawWriter::write( const rxm_sfrbx_t & subframe )
+{
+  write_frame( m_outs, (const uint8_t *) &subframe,
+               sizeof(msg_t) + subframe.length, false );
+  subframes++;
+}
+
+void ubloxRawWriter::write( raw_queue_t & raw )
+{
+  while (raw.subframe_available()) {
+    write( raw.subframe() );
+    raw.subframe_done();
+  }
+  while (raw.epoch_available()) {
+    write( raw.epoch() );
+    raw.epoch_done();
+  }
+}
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef UBXRAW_H
+#define UBXRAW_H
+
+/**
+ * @file ubxRaw.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "ubxmsg.h"
+
+//------------------------------------------------------------------
+//  Capture of the u-blox 8 raw measurements (RXM_RAWX) and navigation
+//  subframes (RXM_SFRBX), for post-processing.
+//
+//  Each message is received directly into a slot of a small ring of
+//  complete message images, so nothing is copied or allocated while
+//  decoding.  The ring has one producer (ubloxGPS::decode, which may
+//  be called from an ISR) and one consumer (loop), and does not need
+//  interrupts to be disabled.  When the ring is full, new messages are
+//  dropped and counted in /overruns/.  Measurements that do not fit in
+//  an epoch slot are dropped and counted in /meas_dropped/.
+//
+//  These are large: each epoch slot uses 20 + 32 * UBLOX_RAW_MAX_MEAS
+//  bytes of RAM.  The default of 48 covers about 40 satellites with a
+//  few dual-frequency signals.  Receivers that track more signals need
+//  a larger UBLOX_RAW_MAX_MEAS (up to 255).
+
+#ifndef UBLOX_RAW_MAX_MEAS
+  #define UBLOX_RAW_MAX_MEAS 48    // measurements kept per epoch
+#endif
+
+#ifndef UBLOX_RAW_EPOCHS
+  #define UBLOX_RAW_EPOCHS 2       // epoch slots
+#endif
+
+#ifndef UBLOX_RAW_SUBFRAMES
+  #define UBLOX_RAW_SUBFRAMES 4    // subframe slots
+#endif
+
+namespace ublox {
+
+    // One complete RXM_RAWX message: the header and its measurements.
+    struct raw_epoch_t : rxm_rawx_t {
+        meas_t meas[ UBLOX_RAW_MAX_MEAS ];
+
+        raw_epoch_t() { length = UBX_MSG_LEN(*this); }
+    }  __attribute__((packed));
+
+    //  A single-producer, single-consumer ring of message slots.  The
+    //  indices run from 0 to 2N-1, so that a full ring can be told apart
+    //  from an empty one without wasting a slot.
+
+    template <class T, uint8_t N>
+    class raw_ring_t
+    {
+    public:
+        raw_ring_t() : overruns( 0 ), m_head( 0 ), m_tail( 0 ) {}
+
+        bool available() const { return m_head != m_tail; }
+        uint8_t count() const
+          {
+            uint8_t head = m_head, tail = m_tail;
+            return (head >= tail) ? head - tail : head + 2*N - tail;
+          }
+
+        //  The oldest message.  Only valid while /available/.
+        const T & oldest() const { return m_slot[ slot( m_tail ) ]; }
+        void      done  () { if (available()) m_tail = next( m_tail ); }
+
+        //  The producer side: a slot to receive into, or NULL if the
+        //  ring is full.  The slot does not become visible until it is
+        //  committed.
+        T *receive()
+          {
+            if (count() == N) {
+              overruns++;
+              return (T *) NULL;
+            }
+            T *msg = &m_slot[ slot( m_head ) ];
+            msg->length = UBX_MSG_LEN(*msg);
+            return msg;
+          }
+        bool receiving( const msg_t *msg ) const
+          { return (msg == &m_slot[ slot( m_head ) ]) && (count() < N); }
+        void commit() { m_head = next( m_head ); }
+
+        uint16_t overruns;
+
+    protected:
+        T                m_slot[ N ];
+        volatile uint8_t m_head;   // written by the producer
+        volatile uint8_t m_tail;   // written by the consumer
+
+        static uint8_t slot( uint8_t i ) { return (i < N) ? i : i - N; }
+        static uint8_t next( uint8_t i ) { return (i == 2*N-1) ? 0 : i+1; }
+    }  __attribute__((packed));
+
+    class raw_queue_t
+    {
+    public:
+        raw_queue_t() : meas_dropped( 0 ) {}
+
+        raw_ring_t<raw_epoch_t, UBLOX_RAW_EPOCHS   > epochs;
+        raw_ring_t<rxm_sfrbx_t, UBLOX_RAW_SUBFRAMES> subframes;
+
+        bool epoch_available() const { return epochs.available(); }
+        const raw_epoch_t & epoch() const { return epochs.oldest(); }
+        void epoch_done() { epochs.done(); }
+
+        bool subframe_available() const { return subframes.available(); }
+        const rxm_sfrbx_t & subframe() const { return subframes.oldest(); }
+        void subframe_done() { subframes.done(); }
+
+        //  Used by the decoder: the slot for a received message, or NULL.
+        msg_t *storage_for( const msg_hdr_t & rx );
+        //  Used by the decoder: publish /msg/ if it is a slot.
+        bool   commit( msg_t *msg );
+
+        //  Measurements that did not fit in an epoch slot
+        uint16_t meas_dropped;
+    }  __attribute__((packed));
+
+}; // namespace ublox
+
+//------------------------------------------------------------------
+/**
+ * Append the captured messages to a log file or stream, as standard
+ * UBX frames.  The file can be read by post-processing tools (e.g.,
+ * RTKLIB's convbin) or decoded again with ubloxGPS::decode_frame.
+ * Only the received measurements are written, not the empty slots.
+ */
+
+class ubloxRawWriter
+{
+public:
+  explicit ubloxRawWriter( Print & outs )
+    : epochs( 0 ), subframes( 0 ), m_outs( outs ) {}
+
+  void write( const ublox::raw_epoch_t & epoch );
+  void write( const ublox::rxm_sfrbx_t & subframe );
+
+  //  Write (and release) everything in the queue.
+  void write( ublox::raw_queue_t & raw );
+
+  uint32_t epochs;
+  uint32_t subframes;
+
+protected:
+  Print & m_outs;
+};
+
+#endif
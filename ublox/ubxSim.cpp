@@ -0,0 +1,632 @@
+/**
+ * @file ubxSim.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "ubxSim.h"
+#include "NMEAencoder.h"
+
+#include <math.h>
+
+using namespace ublox;
+
+//  The class and id of each output_msg_t
+static const uint8_t out_msgs[][2] __PROGMEM =
+  {
+    { UBX_NMEA, UBX_GPGGA },
+    { UBX_NMEA, UBX_GPRMC },
+    { UBX_NAV , UBX_NAV_STATUS  },
+    { UBX_NAV , UBX_NAV_POSLLH  },
+    { UBX_NAV , UBX_NAV_VELNED  },
+    { UBX_NAV , UBX_NAV_TIMEGPS },
+    { UBX_NAV , UBX_NAV_TIMEUTC },
+    { UBX_NAV , UBX_NAV_PVT     }
+  };
+
+//  MON_VER reply: 30-character software and 10-character hardware versions
+static const char mon_ver[40] __PROGMEM =
+  "ROM CORE 3.01 (107888)\0\0\0\0\0\0\0\0" "00080000\0";
+
+//------------------------------------------------------------------
+
+ubloxSimulator::ubloxSimulator()
+  : lat( 473456789L ), lon( -1223456789L ), alt_mm( 100000L ),
+    speed_cms( 1000 ), heading_cd( 4500 ), satellites( 9 ),
+    gps_ms( 0 ),
+    corrupt_every( 0 ), nak_every( 0 ),
+    messages( 0 ), corrupted( 0 ), acks( 0 ), naks( 0 ), overruns( 0 ),
+    m_epochs( 0 ), m_last_ms( 0 ), m_start_ms( millis() ),
+    m_rate( 1000, 1, UBX_TIME_REF_GPS ),
+    m_cmd_state( 0 ), m_cfg_count( 0 )
+{
+  // 2016-01-01 00:00:00 UTC
+  NeoGPS::time_t t;
+  t.init();
+  t.year  = 16;
+  t.month = 1;
+  t.date  = 1;
+  gps_seconds = (NeoGPS::clock_t) t + 17;
+
+  for (uint8_t i=0; i < OUT_COUNT; i++)
+    m_msg_rate[i] = (i <= OUT_RMC) ? 1 : 0;
+
+  m_nav5.apply_word    = 0;
+  m_nav5.dyn_model     = UBX_DYN_MODEL_PORTABLE;
+  m_nav5.fix_mode      = UBX_POS_FIX_AUTO;
+  m_nav5.fixed_alt     = 0;
+  m_nav5.fixed_alt_variance = 10000;
+  m_nav5.min_elev      = 5;
+  m_nav5.dr_limit      = 0;
+  m_nav5.pos_dop_mask  = 250;
+  m_nav5.time_dop_mask = 250;
+  m_nav5.pos_acc_mask  = 100;
+  m_nav5.time_acc_mask = 300;
+  m_nav5.static_hold_thr = 0;
+  m_nav5.dgps_timeout  = 60;
+}
+
+//------------------------------------------------------------------
+//  The receiver's output
+
+int ubloxSimulator::available()
+{
+  return m_out.count;
+}
+
+int ubloxSimulator::peek()
+{
+  return m_out.count ? m_out.buf[ m_out.tail() ] : -1;
+}
+
+int ubloxSimulator::read()
+{
+  int c = peek();
+  if (m_out.count)
+    m_out.count--;
+  return c;
+}
+
+size_t ubloxSimulator::output_t::write( uint8_t c )
+{
+  if (count == UBLOX_SIM_BUFFER_SIZE) {
+    overruns++;
+    return 0;
+  }
+  buf[ head ] = c;
+  head = (head + 1) % UBLOX_SIM_BUFFER_SIZE;
+  count++;
+  return 1;
+}
+
+size_t ubloxSimulator::output_t::write( const uint8_t *bytes, size_t len )
+{
+  for (size_t i=0; i < len; i++)
+    write( bytes[i] );
+  return len;
+}
+
+//------------------------------------------------------------------
+//  Commands are received one character at a time, like the device.
+
+size_t ubloxSimulator::write( uint8_t c )
+{
+  switch (m_cmd_state) {
+    case 0:
+      if (c == SYNC_1)
+        m_cmd_state = 1;
+      break;
+
+    case 1:
+      m_cmd_state = (c == SYNC_2) ? 2 : 0;
+      m_cmd_count = 0;
+      m_cmd_crc_a = 0;
+      m_cmd_crc_b = 0;
+      break;
+
+    case 2: // header
+      m_cmd_crc_a += c;
+      m_cmd_crc_b += m_cmd_crc_a;
+      m_cmd_hdr[ m_cmd_count++ ] = c;
+      if (m_cmd_count == sizeof(m_cmd_hdr)) {
+        m_cmd_count = 0;
+        m_cmd_state = (m_cmd_hdr[2] | m_cmd_hdr[3]) ? 3 : 4;
+      }
+      break;
+
+    case 3: // payload
+      m_cmd_crc_a += c;
+      m_cmd_crc_b += m_cmd_crc_a;
+      if (m_cmd_count < sizeof(m_cmd))
+        m_cmd[ m_cmd_count ] = c;
+      if (++m_cmd_count == (m_cmd_hdr[2] | (m_cmd_hdr[3] << 8)))
+        m_cmd_state = 4;
+      break;
+
+    case 4:
+      m_cmd_state = (c == m_cmd_crc_a) ? 5 : 0;
+      break;
+
+    case 5:
+      m_cmd_state = 0;
+      if (c == m_cmd_crc_b)
+        command( m_cmd_hdr[0], m_cmd_hdr[1], m_cmd_hdr[2] | (m_cmd_hdr[3] << 8) );
+      break;
+  }
+
+  return 1;
+}
+
+size_t ubloxSimulator::write( const uint8_t *buf, size_t len )
+{
+  for (size_t i=0; i < len; i++)
+    write( buf[i] );
+  return len;
+}
+
+//------------------------------------------------------------------
+
+void ubloxSimulator::command( uint8_t msg_class, uint8_t msg_id, uint16_t len )
+{
+  if (msg_class == UBX_CFG) {
+    bool ok;
+    if (len == 0) {
+      // Poll
+      if (msg_id == UBX_CFG_RATE) {
+        send( m_rate );
+        ok = true;
+      } else if (msg_id == UBX_CFG_NAV5) {
+        send( m_nav5 );
+        ok = true;
+      } else
+        ok = false;
+
+    } else if ((msg_id == UBX_CFG_MSG) && (len == 2)) {
+      ok = false;
+      for (uint8_t i=0; i < OUT_COUNT; i++) {
+        if ((pgm_read_byte( &out_msgs[i][0] ) == m_cmd[0]) &&
+            (pgm_read_byte( &out_msgs[i][1] ) == m_cmd[1])) {
+          send( cfg_msg_t( (msg_class_t) m_cmd[0], (msg_id_t) m_cmd[1],
+                           m_msg_rate[i] ) );
+          ok = true;
+        }
+      }
+
+    } else
+      ok = configure( msg_id, len );
+
+    m_cfg_count++;
+    if (nak_every && (m_cfg_count % nak_every == 0))
+      ok = false;
+    ack( msg_class, msg_id, ok );
+
+  } else if (len == 0) {
+    // Poll
+    if ((msg_class == UBX_MON) && (msg_id == UBX_MON_VER)) {
+      uint8_t buf[ sizeof(msg_t) + sizeof(mon_ver) ];
+      msg_t  *reply = (msg_t *) buf;
+      reply->msg_class = UBX_MON;
+      reply->msg_id    = UBX_MON_VER;
+      reply->length    = sizeof(mon_ver);
+      memcpy_P( &buf[ sizeof(msg_t) ], mon_ver, sizeof(mon_ver) );
+      send( *reply );
+    } else
+      output( msg_class, msg_id );
+  }
+
+} // command
+
+//------------------------------------------------------------------
+
+bool ubloxSimulator::configure( uint8_t msg_id, uint16_t len )
+{
+  switch (msg_id) {
+    case UBX_CFG_MSG:
+      if ((len == 3) || (len == 8)) {
+        //  The 8-byte form has a rate for each port; use UART1.
+        uint8_t rate = (len == 3) ? m_cmd[2] : m_cmd[3];
+        for (uint8_t i=0; i < OUT_COUNT; i++) {
+          if ((pgm_read_byte( &out_msgs[i][0] ) == m_cmd[0]) &&
+              (pgm_read_byte( &out_msgs[i][1] ) == m_cmd[1]))
+            m_msg_rate[i] = rate;
+        }
+        return true; // other messages are accepted, but not simulated
+      }
+      break;
+
+    case UBX_CFG_RATE:
+      if (len == UBX_MSG_LEN(m_rate)) {
+        cfg_rate_t rate( 0, 0, UBX_TIME_REF_GPS );
+        memcpy( ((uint8_t *) &rate) + sizeof(msg_t), m_cmd, len );
+        if ((rate.GPS_meas_rate < 25) || (rate.nav_rate == 0))
+          return false;
+        m_rate = rate;
+        return true;
+      }
+      break;
+
+    case UBX_CFG_NAV5:
+      if (len == UBX_MSG_LEN(m_nav5)) {
+        cfg_nav5_t nav5;
+        memcpy( ((uint8_t *) &nav5) + sizeof(msg_t), m_cmd, len );
+        if (nav5.apply.dyn_model)
+          m_nav5.dyn_model = nav5.dyn_model;
+        if (nav5.apply.min_elev)
+          m_nav5.min_elev = nav5.min_elev;
+        if (nav5.apply.fix) {
+          m_nav5.fix_mode           = nav5.fix_mode;
+          m_nav5.fixed_alt          = nav5.fixed_alt;
+          m_nav5.fixed_alt_variance = nav5.fixed_alt_variance;
+        }
+        if (nav5.apply.dr_limit)
+          m_nav5.dr_limit = nav5.dr_limit;
+        if (nav5.apply.pos_mask) {
+          m_nav5.pos_dop_mask = nav5.pos_dop_mask;
+          m_nav5.pos_acc_mask = nav5.pos_acc_mask;
+        }
+        if (nav5.apply.time_mask) {
+          m_nav5.time_dop_mask = nav5.time_dop_mask;
+          m_nav5.time_acc_mask = nav5.time_acc_mask;
+        }
+        if (nav5.apply.static_hold_thr)
+          m_nav5.static_hold_thr = nav5.static_hold_thr;
+        if (nav5.apply.dgps_timeout)
+          m_nav5.dgps_timeout = nav5.dgps_timeout;
+        return true;
+      }
+      break;
+
+    default:
+      return true; // accepted, but not simulated
+  }
+
+  return false;
+
+} // configure
+
+//------------------------------------------------------------------
+
+void ubloxSimulator::ack( uint8_t msg_class, uint8_t msg_id, bool ok )
+{
+  uint8_t buf[ sizeof(msg_t) + 2 ];
+  msg_t  *msg = (msg_t *) buf;
+  msg->msg_class = UBX_ACK;
+  msg->msg_id    = ok ? UBX_ACK_ACK : UBX_ACK_NAK;
+  msg->length    = 2;
+  buf[ sizeof(msg_t)   ] = msg_class;
+  buf[ sizeof(msg_t)+1 ] = msg_id;
+  send( *msg );
+
+  if (ok)
+    acks++;
+  else
+    naks++;
+}
+
+//------------------------------------------------------------------
+
+void ubloxSimulator::run( uint32_t now_ms )
+{
+  uint32_t late = now_ms - m_last_ms;
+  if (late >= 4UL * m_rate.GPS_meas_rate) {
+    m_last_ms = now_ms;
+    epoch();
+  } else {
+    while (late >= m_rate.GPS_meas_rate) {
+      m_last_ms += m_rate.GPS_meas_rate;
+      late      -= m_rate.GPS_meas_rate;
+      epoch();
+    }
+  }
+}
+
+//------------------------------------------------------------------
+
+void ubloxSimulator::epoch()
+{
+  for (uint8_t i=0; i < OUT_COUNT; i++) {
+    if (m_msg_rate[i] && (m_epochs % m_msg_rate[i] == 0))
+      output( (output_msg_t) i );
+  }
+  m_epochs++;
+
+  // Advance the time
+  uint16_t interval = m_rate.GPS_meas_rate;
+  gps_seconds += interval / 1000;
+  gps_ms      += interval % 1000;
+  if (gps_ms >= 1000) {
+    gps_ms -= 1000;
+    gps_seconds++;
+  }
+
+  // Advance the position
+  const float M_PER_DEG_E7 = 111319.49 / 1.0e7;
+  float dist_m  = speed_cms * (interval / 100000.0);
+  float heading = heading_cd * (M_PI / 18000.0);
+  lat += (int32_t) (dist_m * cos( heading ) / M_PER_DEG_E7);
+  lon += (int32_t) (dist_m * sin( heading ) /
+                    (M_PER_DEG_E7 * cos( lat * (M_PI / 1.8e9) )));
+
+} // epoch
+
+//------------------------------------------------------------------
+
+bool ubloxSimulator::output( uint8_t msg_class, uint8_t msg_id )
+{
+  for (uint8_t i=0; i < OUT_COUNT; i++) {
+    if ((pgm_read_byte( &out_msgs[i][0] ) == msg_class) &&
+        (pgm_read_byte( &out_msgs[i][1] ) == msg_id)) {
+      output( (output_msg_t) i );
+      return true;
+    }
+  }
+  return false;
+}
+
+void ubloxSimulator::output( output_msg_t msg )
+{
+  int32_t  vn_cms   = (int32_t) (speed_cms * cos( heading_cd * (M_PI / 18000.0) ));
+  int32_t  ve_cms   = (int32_t) (speed_cms * sin( heading_cd * (M_PI / 18000.0) ));
+  uint32_t tow      = time_of_week_ms();
+
+  switch (msg) {
+    case OUT_GGA:
+    case OUT_RMC:
+      {
+        gps_fix fix;
+        fill( fix );
+        NMEAencoder nmea;
+        char        buf[ NMEAencoder::MAX_LENGTH ];
+        uint8_t     len = (msg == OUT_GGA) ? nmea.GGA( buf, fix ) : nmea.RMC( buf, fix );
+        send( buf, len );
+      }
+      break;
+
+    case OUT_STATUS:
+      {
+        nav_status_t status;
+        memset( ((uint8_t *) &status) + sizeof(msg_t), 0, status.length );
+        status.time_of_week       = tow;
+        status.status             = nav_status_t::NAV_STAT_3D;
+        status.flags.gps_fix      = true;
+        status.flags.week         = true;
+        status.flags.time_of_week = true;
+        status.time_to_first_fix  = 30000;
+        status.uptime             = millis() - m_start_ms;
+        send( status );
+      }
+      break;
+
+    case OUT_POSLLH:
+      {
+        nav_posllh_t posllh;
+        posllh.time_of_week           = tow;
+        posllh.lon                    = lon;
+        posllh.lat                    = lat;
+        posllh.height_above_ellipsoid = alt_mm - 20000;
+        posllh.height_MSL             = alt_mm;
+        posllh.horiz_acc              = 2500;
+        posllh.vert_acc               = 4000;
+        send( posllh );
+      }
+      break;
+
+    case OUT_VELNED:
+      {
+        nav_velned_t velned;
+        velned.time_of_week = tow;
+        velned.vel_north    = vn_cms;
+        velned.vel_east     = ve_cms;
+        velned.vel_down     = 0;
+        velned.speed_3D     = speed_cms;
+        velned.speed_2D     = speed_cms;
+        velned.heading      = heading_cd * 1000L;
+        velned.speed_acc    = 20;
+        velned.heading_acc  = 100000L;
+        send( velned );
+      }
+      break;
+
+    case OUT_TIMEGPS:
+      {
+        nav_timegps_t timegps;
+        timegps.time_of_week   = tow;
+        timegps.fractional_ToW = 0;
+        timegps.week           = (gps_seconds + GPSTime::gps_epoch_offset()) /
+                                   GPSTime::SECONDS_PER_WEEK;
+        timegps.leap_seconds   = GPSTime::leap_seconds_at( gps_seconds );
+        *(uint8_t *) &timegps.valid = 0;
+        timegps.valid.time_of_week = true;
+        timegps.valid.week         = true;
+        timegps.valid.leap_seconds = true;
+        send( timegps );
+      }
+      break;
+
+    case OUT_TIMEUTC:
+      {
+        nav_timeutc_t timeutc;
+        fill( timeutc );
+        send( timeutc );
+      }
+      break;
+
+    case OUT_PVT:
+      {
+        nav_timeutc_t utc;
+        fill( utc );
+
+        nav_pvt_t pvt;
+        memset( ((uint8_t *) &pvt) + sizeof(msg_t), 0, pvt.length );
+        pvt.time_of_week   = tow;
+        pvt.year           = utc.year;
+        pvt.month          = utc.month;
+        pvt.day            = utc.day;
+        pvt.hour           = utc.hour;
+        pvt.minute         = utc.minute;
+        pvt.second         = utc.second;
+        pvt.valid.date     = true;
+        pvt.valid.time     = true;
+        pvt.valid.fully_resolved = true;
+        pvt.time_accuracy  = utc.time_accuracy;
+        pvt.nanoseconds    = utc.fractional_ToW;
+        pvt.fix_type       = nav_status_t::NAV_STAT_3D;
+        pvt.flags.gnss_fix_ok = true;
+        pvt.num_sv         = satellites;
+        pvt.lon            = lon;
+        pvt.lat            = lat;
+        pvt.height_above_ellipsoid = alt_mm - 20000;
+        pvt.height_MSL     = alt_mm;
+        pvt.horiz_acc      = 2500;
+        pvt.vert_acc       = 4000;
+        pvt.vel_north      = vn_cms * 10;
+        pvt.vel_east       = ve_cms * 10;
+        pvt.ground_speed   = speed_cms * 10L;
+        pvt.heading_motion = heading_cd * 1000L;
+        pvt.speed_acc      = 200;
+        pvt.heading_acc    = 100000L;
+        pvt.pdop           = 150;
+        send( pvt );
+      }
+      break;
+
+    default:
+      break;
+  }
+
+} // output
+
+//------------------------------------------------------------------
+
+uint32_t ubloxSimulator::time_of_week_ms() const
+{
+  uint32_t s = (gps_seconds + GPSTime::gps_epoch_offset()) %
+                 GPSTime::SECONDS_PER_WEEK;
+  return s * 1000UL + gps_ms;
+}
+
+void ubloxSimulator::fill( nav_timeutc_t & utc ) const
+{
+  NeoGPS::time_t t( gps_seconds - GPSTime::leap_seconds_at( gps_seconds ) );
+
+  utc.time_of_week   = time_of_week_ms();
+  utc.time_accuracy  = 50;
+  utc.fractional_ToW = gps_ms * 1000000L;
+  utc.year           = t.full_year();
+  utc.month          = t.month;
+  utc.day            = t.date;
+  utc.hour           = t.hours;
+  utc.minute         = t.minutes;
+  utc.second         = t.seconds;
+  *(uint8_t *) &utc.valid = 0;
+  utc.valid.time_of_week = true;
+  utc.valid.week_number  = true;
+  utc.valid.UTC          = true;
+}
+
+void ubloxSimulator::fill( gps_fix & fix ) const
+{
+  fix.init();
+
+  fix.status       = gps_fix::STATUS_STD;
+  fix.valid.status = true;
+
+  #if defined(GPS_FIX_DATE) | defined(GPS_FIX_TIME)
+    fix.dateTime    = gps_seconds - GPSTime::leap_seconds_at( gps_seconds );
+    fix.dateTime_cs = gps_ms / 10;
+  #endif
+  #ifdef GPS_FIX_DATE
+    fix.valid.date = true;
+  #endif
+  #ifdef GPS_FIX_TIME
+    fix.valid.time = true;
+  #endif
+
+  #ifdef GPS_FIX_LOCATION
+    fix.lat = lat;
+    fix.lon = lon;
+    fix.valid.location = true;
+  #endif
+
+  #ifdef GPS_FIX_ALTITUDE
+    fix.alt.whole = alt_mm / 1000;
+    fix.alt.frac  = (alt_mm % 1000) / 10;
+    fix.valid.altitude = true;
+  #endif
+
+  #ifdef GPS_FIX_SPEED
+    uint32_t mkn  = (speed_cms * 19438UL) / 1000; // 0.01 m/s to 0.001 kn
+    fix.spd.whole = mkn / 1000;
+    fix.spd.frac  = mkn % 1000;
+    fix.valid.speed = true;
+  #endif
+
+  #ifdef GPS_FIX_HEADING
+    fix.hdg.whole = heading_cd / 100;
+    fix.hdg.frac  = heading_cd % 100;
+    fix.valid.heading = true;
+  #endif
+
+  #ifdef GPS_FIX_SATELLITES
+    fix.satellites = satellites;
+    fix.valid.satellites = true;
+  #endif
+
+  #ifdef GPS_FIX_HDOP
+    fix.hdop = 900;
+    fix.valid.hdop = true;
+  #endif
+
+  #ifdef GPS_FIX_GEOID_HEIGHT
+    fix.geoidHt.whole = -20;
+    fix.geoidHt.frac  = 0;
+    fix.valid.geoidHeight = true;
+  #endif
+}
+
+//------------------------------------------------------------------
+
+bool ubloxSimulator::corrupt_next()
+{
+  messages++;
+  if (corrupt_every && (messages % corrupt_every == 0)) {
+    corrupted++;
+    return true;
+  }
+  return false;
+}
+
+//  A corrupted UBX message has a bad checksum.
+
+void ubloxSimulator::send( const msg_t & msg )
+{
+  uint32_t dropped = m_out.overruns;
+  write_frame( m_out, (const uint8_t *) &msg, sizeof(msg_t) + msg.length, false );
+  overruns = m_out.overruns;
+
+  if (corrupt_next() && (dropped == m_out.overruns))
+    m_out.buf[ (m_out.head + UBLOX_SIM_BUFFER_SIZE - 1) % UBLOX_SIM_BUFFER_SIZE ] ^= 0xFF;
+}
+
+//  A corrupted NMEA sentence has a changed character in the middle.
+
+void ubloxSimulator::send( char *sentence, uint8_t len )
+{
+  if (corrupt_next())
+    sentence[ len/2 ] ^= 0x01;
+
+  m_out.write( (const uint8_t *) sentence, len );
+  overruns = m_out.overruns;
+}
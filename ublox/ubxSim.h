@@ -0,0 +1,160 @@
+#ifndef UBXSIM_H
+#define UBXSIM_H
+
+/**
+ * @file ubxSim.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2016, SlashDevin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "ubxGPS.h"
+
+//------------------------------------------------------------------
+//  A simulated ublox receiver, for testing and benchmarking the ublox
+//  classes without a device.
+//
+//  Pass it to ubloxGPS as the device Stream.  The commands that are
+//  written to it are answered immediately: CFG messages are ACKed (or
+//  NAKed), and polls of MON_VER, CFG_RATE, CFG_NAV5, CFG_MSG and the
+//  NAV messages are replied.  /run/ or /epoch/ generate the navigation
+//  messages that were enabled with CFG_MSG, at the CFG_RATE interval.
+//  The vehicle moves at a constant speed and heading.
+//
+//  The simulated output is kept in a buffer until it is read.  If it
+//  is not read quickly enough, characters are dropped (and counted),
+//  just like a UART overrun.
+//
+//  Supported output messages: NMEA GGA and RMC (enabled by default),
+//  and UBX NAV STATUS, POSLLH, VELNED, TIMEGPS, TIMEUTC and PVT.
+
+#ifndef UBLOX_SIM_BUFFER_SIZE
+  #define UBLOX_SIM_BUFFER_SIZE 512
+#endif
+
+class ubloxSimulator : public Stream
+{
+public:
+  ubloxSimulator();
+
+  //  The receiver's output
+  int  available();
+  int  read();
+  int  peek();
+  void flush() {}
+
+  //  Commands to the receiver
+  size_t write( uint8_t c );
+  size_t write( const uint8_t *buf, size_t len );
+  using Print::write;
+
+  /**
+   * Generate the epochs that are due by /now_ms/.  If the caller has
+   * fallen more than a few epochs behind, the missed epochs are skipped.
+   */
+  void run( uint32_t now_ms );
+  void run() { run( millis() ); }
+
+  /**
+   * Generate one epoch immediately, then advance the simulated time
+   * and position by the measurement interval.
+   */
+  void epoch();
+
+  //  The simulated vehicle.  These can be changed at any time.
+  int32_t   lat;          // degrees * 1e7
+  int32_t   lon;          // degrees * 1e7
+  int32_t   alt_mm;       // MSL
+  uint16_t  speed_cms;    // cm/s
+  uint16_t  heading_cd;   // degrees * 100
+  uint8_t   satellites;
+
+  //  GPS seconds since the NeoGPS epoch, and the milliseconds.
+  NeoGPS::clock_t gps_seconds;
+  uint16_t        gps_ms;
+
+  //  Error injection.  0 means never.
+  uint16_t  corrupt_every;  // corrupt 1 of every N messages
+  uint16_t  nak_every;      // NAK 1 of every N CFG messages
+
+  //  Counters
+  uint32_t  messages;       // sent, including ACKs and replies
+  uint32_t  corrupted;
+  uint16_t  acks;
+  uint16_t  naks;
+  uint32_t  overruns;       // characters dropped
+
+  uint16_t  meas_rate_ms() const { return m_rate.GPS_meas_rate; }
+
+protected:
+
+  //  The output buffer is written through this Print, so that the
+  //  standard UBX and NMEA writers can be used.
+  class output_t : public Print
+  {
+  public:
+    output_t() : head( 0 ), count( 0 ), overruns( 0 ) {}
+    size_t write( uint8_t c );
+    size_t write( const uint8_t *buf, size_t len );
+    using Print::write;
+
+    uint8_t   buf[ UBLOX_SIM_BUFFER_SIZE ];
+    uint16_t  head;  // next write
+    uint16_t  count;
+    uint32_t  overruns;
+
+    uint16_t tail() const
+      { return (head + UBLOX_SIM_BUFFER_SIZE - count) % UBLOX_SIM_BUFFER_SIZE; }
+  };
+  output_t m_out;
+
+  enum output_msg_t {
+    OUT_GGA, OUT_RMC,
+    OUT_STATUS, OUT_POSLLH, OUT_VELNED, OUT_TIMEGPS, OUT_TIMEUTC, OUT_PVT,
+    OUT_COUNT
+  };
+  uint8_t  m_msg_rate[ OUT_COUNT ];  // per epoch, 0 = off
+  uint32_t m_epochs;
+  uint32_t m_last_ms;
+  uint32_t m_start_ms;              // for NAV_STATUS uptime
+
+  ublox::cfg_rate_t m_rate;
+  ublox::cfg_nav5_t m_nav5;
+
+  //  Command receiver
+  uint8_t  m_cmd_state;
+  uint8_t  m_cmd_hdr[4];            // class, id, length
+  uint8_t  m_cmd[ 40 ];             // payload (longer ones are truncated)
+  uint16_t m_cmd_count;
+  uint8_t  m_cmd_crc_a;
+  uint8_t  m_cmd_crc_b;
+  uint16_t m_cfg_count;
+
+  void command( uint8_t msg_class, uint8_t msg_id, uint16_t len );
+  bool configure( uint8_t msg_id, uint16_t len );
+  void ack( uint8_t msg_class, uint8_t msg_id, bool ok );
+
+  //  Output one message
+  bool output( uint8_t msg_class, uint8_t msg_id );
+  void output( output_msg_t msg );
+  void send( const ublox::msg_t & msg );
+  void send( char *sentence, uint8_t len );
+  bool corrupt_next();
+
+  uint32_t time_of_week_ms() const;
+  void     fill( ublox::nav_timeutc_t & utc ) const;
+  void     fill( gps_fix & fix ) const;
+};
+
+#endif
@@ -2,24 +2,140 @@
 
 using namespace ublox;
 
+//---------------------------------
+//  Each byte is added to A, and then A is added to B.  For a block of
+//  4 bytes, this is the same as
+//
+//     B += 4*A + 4*x0 + 3*x1 + 2*x2 + x3    (the sum of the prefix sums)
+//     A +=   x0 +   x1 +   x2 + x3
+//
+//  On 32-bit targets, the 4 bytes are loaded as one word, split into
+//  two pairs of 16-bit lanes (x0/x2 and x1/x3), and each weighted sum
+//  is one multiply: the upper lane of the product collects the terms.
+//  Only the low 8 bits of A and B are used, so the 32-bit sums can
+//  overflow harmlessly.
+//
+//  AVRs do not have a 32-bit multiplier, so they use the byte loop.
+
+void ublox::fletcher8( const uint8_t *bytes, uint16_t len,
+                       uint8_t & crc_a, uint8_t & crc_b )
+{
+  uint8_t a = crc_a;
+  uint8_t b = crc_b;
+
+  #if !defined(__AVR__) & defined(__BYTE_ORDER__)
+    #if (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+      uint32_t A = a;
+      uint32_t B = b;
+
+      while (len >= 4) {
+        uint32_t w;
+        memcpy( &w, bytes, sizeof(w) ); // may not be aligned
+        bytes += 4;
+        len   -= 4;
+
+        uint32_t even = w & 0x00FF00FFUL;        // x0 and x2
+        uint32_t odd  = (w >> 8) & 0x00FF00FFUL; // x1 and x3
+
+        B += (A << 2) +
+             ((even * 0x00040002UL) >> 16) +  // 4*x0 + 2*x2
+             ((odd  * 0x00030001UL) >> 16);   // 3*x1 +   x3
+        A += ((even + odd) * 0x00010001UL) >> 16;
+      }
+
+      a = A;
+      b = B;
+    #endif
+  #endif
+
+  while (len--) {
+    a += *bytes++;
+    b += a;
+  }
+
+  crc_a = a;
+  crc_b = b;
+
+} // fletcher8
+
+//---------------------------------
+
+void ublox::write_frame
+  ( Print & outs, const uint8_t *bytes, uint16_t len, bool progmem )
+{
+  uint8_t buf[ 64 ];
+  uint8_t n     = 0;
+  uint8_t crc_a = 0;
+  uint8_t crc_b = 0;
+
+  buf[ n++ ] = SYNC_1;
+  buf[ n++ ] = SYNC_2;
+
+  while (len) {
+    uint8_t count = sizeof(buf) - n;
+    if (count > len)
+      count = len;
+
+    if (progmem)
+      memcpy_P( &buf[n], bytes, count );
+    else
+      memcpy( &buf[n], bytes, count );
+    fletcher8( &buf[n], count, crc_a, crc_b );
+    bytes += count;
+    len   -= count;
+
+    n += count;
+    if (n == sizeof(buf)) {
+      outs.write( buf, n );
+      n = 0;
+    }
+  }
+
+  if (n > sizeof(buf) - 2) {
+    outs.write( buf, n );
+    n = 0;
+  }
+  buf[ n++ ] = crc_a;
+  buf[ n++ ] = crc_b;
+  outs.write( buf, n );
+
+} // write_frame
+
 bool ublox::configNMEA( ubloxGPS &gps, NMEAGPS::nmea_msg_t msgType, uint8_t rate )
 {
-  static const ubx_nmea_msg_t ubx[] __PROGMEM = {
-        UBX_GPGGA,
-        UBX_GPGLL,
-        UBX_GPGSA,
-        UBX_GPGSV,
-        UBX_GPRMC,
-        UBX_GPVTG,
-        UBX_GPZDA,
-    };
-
-  uint8_t msg_index = (uint8_t) msgType - (uint8_t) NMEAGPS::NMEA_FIRST_MSG;
-
-  if (msg_index >= sizeof(ubx)/sizeof(ubx[0]))
-    return false;
-
-  msg_id_t msg_id = (msg_id_t) pgm_read_byte( &ubx[msg_index] );
+  //  The nmea_msg_t values depend on which messages are configured,
+  //    so they cannot index a table of UBX msg_id's.
+
+  msg_id_t msg_id;
+
+  switch (msgType) {
+    #if defined(NMEAGPS_PARSE_GGA) | defined(NMEAGPS_RECOGNIZE_ALL)
+      case NMEAGPS::NMEA_GGA: msg_id = (msg_id_t) UBX_GPGGA; break;
+    #endif
+    #if defined(NMEAGPS_PARSE_GLL) | defined(NMEAGPS_RECOGNIZE_ALL)
+      case NMEAGPS::NMEA_GLL: msg_id = (msg_id_t) UBX_GPGLL; break;
+    #endif
+    #if defined(NMEAGPS_PARSE_GSA) | defined(NMEAGPS_RECOGNIZE_ALL)
+      case NMEAGPS::NMEA_GSA: msg_id = (msg_id_t) UBX_GPGSA; break;
+    #endif
+    #if defined(NMEAGPS_PARSE_GST) | defined(NMEAGPS_RECOGNIZE_ALL)
+      case NMEAGPS::NMEA_GST: msg_id = (msg_id_t) UBX_GPGST; break;
+    #endif
+    #if defined(NMEAGPS_PARSE_GSV) | defined(NMEAGPS_RECOGNIZE_ALL)
+      case NMEAGPS::NMEA_GSV: msg_id = (msg_id_t) UBX_GPGSV; break;
+    #endif
+    #if defined(NMEAGPS_PARSE_RMC) | defined(NMEAGPS_RECOGNIZE_ALL)
+      case NMEAGPS::NMEA_RMC: msg_id = (msg_id_t) UBX_GPRMC; break;
+    #endif
+    #if defined(NMEAGPS_PARSE_VTG) | defined(NMEAGPS_RECOGNIZE_ALL)
+      case NMEAGPS::NMEA_VTG: msg_id = (msg_id_t) UBX_GPVTG; break;
+    #endif
+    #if defined(NMEAGPS_PARSE_ZDA) | defined(NMEAGPS_RECOGNIZE_ALL)
+      case NMEAGPS::NMEA_ZDA: msg_id = (msg_id_t) UBX_GPZDA; break;
+    #endif
+    default:
+      return false;
+  }
 
   return gps.send( cfg_msg_t( UBX_NMEA, msg_id, rate ) );
 }
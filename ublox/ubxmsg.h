@@ -6,6 +6,9 @@ class ubloxGPS;
 
 namespace ublox {
 
+    static const uint8_t SYNC_1 = 0xB5;
+    static const uint8_t SYNC_2 = 0x62;
+
     enum msg_class_t
       { UBX_NAV  = 0x01,  // Navigation results
         UBX_RXM  = 0x02,  // Receiver Manager messages
@@ -30,10 +33,13 @@ namespace ublox {
         UBX_MON_VER     = 0x04, // Monitor Receiver/Software version
         UBX_NAV_POSLLH  = 0x02, // Current Position
         UBX_NAV_STATUS  = 0x03, // Receiver Navigation Status
+        UBX_NAV_PVT     = 0x07, // Navigation Position Velocity Time Solution
         UBX_NAV_VELNED  = 0x12, // Current Velocity
         UBX_NAV_TIMEGPS = 0x20, // Current GPS Time
         UBX_NAV_TIMEUTC = 0x21, // Current UTC Time
         UBX_NAV_SVINFO  = 0x30, // Space Vehicle Information
+        UBX_RXM_SFRBX   = 0x13, // Broadcast Navigation Data Subframe
+        UBX_RXM_RAWX    = 0x15, // Multi-GNSS Raw Measurement Data
         UBX_ID_UNK   = 0xFF
       }  __attribute__((packed));
 
@@ -60,6 +66,24 @@ namespace ublox {
           }
       } __attribute__((packed));
 
+    /**
+      * Accumulate the 8-bit Fletcher checksum of the UBX class, id,
+      * length and payload bytes.  A frame can be passed in several
+      * blocks: /crc_a/ and /crc_b/ carry the sums from one call to the
+      * next, and must start at 0.
+      */
+    extern void fletcher8( const uint8_t *bytes, uint16_t len,
+                           uint8_t & crc_a, uint8_t & crc_b );
+
+    /**
+      * Write a complete frame: the sync characters, the message bytes
+      * (class, id, length and payload) and the checksum.  Most messages
+      * are written with one call; longer messages are written in
+      * chunks.
+      */
+    extern void write_frame( Print & outs, const uint8_t *bytes,
+                             uint16_t len, bool progmem );
+
     /**
       * Configure message intervals.
       */
@@ -71,6 +95,7 @@ namespace ublox {
         UBX_GPGSV = 0x03,
         UBX_GPRMC = 0x04,
         UBX_GPVTG = 0x05,
+        UBX_GPGST = 0x07,
         UBX_GPZDA = 0x08
     } __attribute__((packed));
 
@@ -328,7 +353,7 @@ namespace ublox {
           uint8_t  elevation;     // degrees
           uint16_t azimuth;       // degrees
           uint32_t pr_res;        // pseudo range residual in cm
-        };
+        } __attribute__((packed));
 
         //  Calculate the number of bytes required to hold the
         //  specified number of channels.
@@ -345,6 +370,132 @@ namespace ublox {
 
       }  __attribute__((packed));
 
+    // Navigation Position Velocity Time Solution (u-blox 7 and later)
+    struct nav_pvt_t : msg_t {
+        uint32_t time_of_week;   // mS
+        uint16_t year;           // 1999..2099
+        uint8_t  month;          // 1..12
+        uint8_t  day;            // 1..31
+        uint8_t  hour;           // 0..23
+        uint8_t  minute;         // 0..59
+        uint8_t  second;         // 0..60
+        struct valid_t {
+          bool date          :1;
+          bool time          :1;
+          bool fully_resolved:1;
+          bool mag_dec       :1;
+        } __attribute__((packed))
+          valid;
+        uint32_t time_accuracy;  // nS
+        int32_t  nanoseconds;    // -1e9..1e9, added to the (rounded) UTC time
+        nav_status_t::status_t fix_type;
+        struct flags_t {
+          bool    gnss_fix_ok   :1; // same bits as nav_status_t::flags_t
+          bool    diff_soln     :1;
+          uint8_t psm_state     :3;
+          bool    head_veh_valid:1;
+          uint8_t carrier_soln  :2;
+        } __attribute__((packed))
+          flags;
+        uint8_t  flags2;
+        uint8_t  num_sv;         // used in the solution
+        int32_t  lon;            // deg * 1e7
+        int32_t  lat;            // deg * 1e7
+        int32_t  height_above_ellipsoid; // mm
+        int32_t  height_MSL;     // mm
+        uint32_t horiz_acc;      // mm
+        uint32_t vert_acc;       // mm
+        int32_t  vel_north;      // mm/s
+        int32_t  vel_east;       // mm/s
+        int32_t  vel_down;       // mm/s
+        int32_t  ground_speed;   // mm/s
+        int32_t  heading_motion; // degrees * 1e5
+        uint32_t speed_acc;      // mm/s
+        uint32_t heading_acc;    // degrees * 1e5
+        uint16_t pdop;           // x0.01
+        uint8_t  reserved1[6];
+        int32_t  heading_vehicle;// degrees * 1e5
+        int16_t  mag_dec;        // degrees * 1e2
+        uint16_t mag_acc;        // degrees * 1e2
+
+        nav_pvt_t() : msg_t( UBX_NAV, UBX_NAV_PVT, UBX_MSG_LEN(*this) ) {};
+    }  __attribute__((packed));
+
+    //  The raw measurements contain IEEE-754 doubles and floats.  They
+    //  are kept as bit patterns, because a double only has 32 bits on
+    //  AVRs.  The accessors are only available where a double has 64.
+
+    #if (__SIZEOF_DOUBLE__ == 8)
+      static inline double r8_to_double( uint64_t r8 )
+        { double d; memcpy( &d, &r8, sizeof(d) ); return d; }
+    #endif
+    static inline float r4_to_float( uint32_t r4 )
+      { float f; memcpy( &f, &r4, sizeof(f) ); return f; }
+
+    // Multi-GNSS Raw Measurement Data (u-blox 8)
+    struct rxm_rawx_t : msg_t {
+        uint64_t rcv_tow;        // s, R8
+        uint16_t week;
+        int8_t   leap_seconds;   // GPS-UTC
+        uint8_t  num_meas;
+        struct rec_stat_t {
+          bool leap_seconds:1;   // valid
+          bool clock_reset :1;
+        } __attribute__((packed))
+          rec_stat;
+        uint8_t  reserved1[3];
+
+        struct meas_t {
+          uint64_t pr_mes;       // pseudorange m, R8
+          uint64_t cp_mes;       // carrier phase cycles, R8
+          uint32_t do_mes;       // Doppler Hz, R4
+          uint8_t  gnss_id;
+          uint8_t  sv_id;
+          uint8_t  reserved2;
+          uint8_t  freq_id;      // GLONASS only
+          uint16_t locktime;     // ms
+          uint8_t  cno;          // dBHz
+          uint8_t  pr_stdev;     // 0.01m * 2^n (low 4 bits)
+          uint8_t  cp_stdev;     // 0.004 cycles * n (low 4 bits)
+          uint8_t  do_stdev;     // 0.002Hz * 2^n (low 4 bits)
+          struct trk_stat_t {
+            bool pr_valid    :1;
+            bool cp_valid    :1;
+            bool half_cycle  :1; // half cycle valid
+            bool sub_half_cyc:1; // half cycle subtracted from phase
+          } __attribute__((packed))
+            trk_stat;
+          uint8_t  reserved3;
+
+          #if (__SIZEOF_DOUBLE__ == 8)
+            double pseudorange () const { return r8_to_double( pr_mes ); }
+            double carrierPhase() const { return r8_to_double( cp_mes ); }
+          #endif
+          float    doppler     () const { return r4_to_float ( do_mes ); }
+        } __attribute__((packed));
+
+        #if (__SIZEOF_DOUBLE__ == 8)
+          double receiverTOW() const { return r8_to_double( rcv_tow ); }
+        #endif
+
+        rxm_rawx_t() : msg_t( UBX_RXM, UBX_RXM_RAWX, UBX_MSG_LEN(*this) ) {};
+    }  __attribute__((packed));
+
+    // Broadcast Navigation Data Subframe (u-blox 8)
+    struct rxm_sfrbx_t : msg_t {
+        uint8_t  gnss_id;
+        uint8_t  sv_id;
+        uint8_t  reserved1;
+        uint8_t  freq_id;        // GLONASS only
+        uint8_t  num_words;
+        uint8_t  channel;
+        uint8_t  version;
+        uint8_t  reserved2;
+        uint32_t words[ 10 ];    // GPS, Galileo, BeiDou and GLONASS fit
+
+        rxm_sfrbx_t() : msg_t( UBX_RXM, UBX_RXM_SFRBX, UBX_MSG_LEN(*this) ) {};
+    }  __attribute__((packed));
+
     struct cfg_nmea_t : msg_t {
         bool  always_output_pos  :1; // invalid or failed
         bool  output_invalid_pos :1;
@@ -420,6 +571,85 @@ namespace ublox {
 
       }  __attribute__((packed));
 
+#if __cplusplus >= 201103L
+
+    //------------------------------------------------------------------
+    //  Complete frames built at compile time.
+    //
+    //  A constant configuration message can be declared as a frame_P
+    //  with its payload bytes.  The sync characters, length and checksum
+    //  are calculated by the compiler, and the whole frame is placed in
+    //  PROGMEM.  It is sent with one block write (see
+    //  ubloxGPS::send_frame_P), without building a msg_t in RAM or
+    //  calculating the checksum at run time:
+    //
+    //    typedef ublox::cfg_rate_P<200> rate_5Hz;
+    //    gps.send_frame_P( rate_5Hz::bytes );
+    //
+    //  Use UBX_U2 and UBX_U4 for the little-endian multi-byte fields.
+
+    #define UBX_U2(x) \
+      (uint8_t)(x), (uint8_t)((uint16_t)(x) >> 8)
+    #define UBX_U4(x) \
+      (uint8_t)(x), (uint8_t)((uint32_t)(x) >> 8), \
+      (uint8_t)((uint32_t)(x) >> 16), (uint8_t)((uint32_t)(x) >> 24)
+
+    //  The running sums are carried in one word: A in the low byte and
+    //  B in the high byte.
+    constexpr uint16_t fletcher8_ab( uint8_t a, uint8_t b )
+      { return a | ((uint16_t) (uint8_t)(b + a) << 8); }
+
+    constexpr uint16_t fletcher8_c( uint16_t ab )
+      { return ab; }
+
+    template <typename... Bytes>
+    constexpr uint16_t fletcher8_c( uint16_t ab, uint8_t c, Bytes... rest )
+      { return fletcher8_c( fletcher8_ab( ab + c, ab >> 8 ), rest... ); }
+
+    template <msg_class_t C, msg_id_t I, uint8_t... Payload>
+    struct frame_P {
+        static const uint16_t LENGTH = sizeof...(Payload);
+        static const uint16_t CRC =
+          fletcher8_c( 0, C, I, (uint8_t) LENGTH, LENGTH >> 8, Payload... );
+
+        static const uint8_t bytes[ LENGTH + 8 ];
+    };
+
+    template <msg_class_t C, msg_id_t I, uint8_t... Payload>
+    const uint8_t frame_P<C,I,Payload...>::bytes[ LENGTH + 8 ] __PROGMEM =
+      { SYNC_1, SYNC_2, C, I, (uint8_t) LENGTH, LENGTH >> 8,
+        Payload...,
+        (uint8_t) CRC, CRC >> 8 };
+
+    //  The common configuration messages
+
+    template <msg_class_t C, msg_id_t I, uint8_t rate>
+    using cfg_msg_P = frame_P< UBX_CFG, UBX_CFG_MSG, C, I, rate >;
+
+    template <uint16_t meas_rate_ms, uint16_t nav_rate = 1,
+              time_ref_t time_ref = UBX_TIME_REF_GPS>
+    using cfg_rate_P = frame_P< UBX_CFG, UBX_CFG_RATE,
+                                UBX_U2(meas_rate_ms), UBX_U2(nav_rate),
+                                UBX_U2(time_ref) >;
+
+    //  Only the dynamic model is applied; the other settings are kept.
+    template <dyn_model_t model>
+    using cfg_nav5_P = frame_P< UBX_CFG, UBX_CFG_NAV5,
+                                UBX_U2(0x0001), model, 0,
+                                UBX_U4(0), UBX_U4(0), 0, 0,
+                                UBX_U2(0), UBX_U2(0), UBX_U2(0), UBX_U2(0),
+                                0, 0,
+                                UBX_U4(0), UBX_U4(0), UBX_U4(0) >;
+
+    //  CFG_NMEA (version 0): the filter flags, NMEA version, number of
+    //  SVs per talker ID and the compatibility flags.
+    template <uint8_t filter, uint8_t nmea_version, uint8_t num_sv = 0,
+              uint8_t flags = 0>
+    using cfg_nmea_P = frame_P< UBX_CFG, UBX_CFG_NMEA,
+                                filter, nmea_version, num_sv, flags >;
+
+#endif
+
 };
 
 #endif
\ No newline at end of file